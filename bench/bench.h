@@ -0,0 +1,165 @@
+#pragma once
+#include <string>
+#include <utility>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <cstdlib>
+#include <new>
+
+namespace Bench {
+
+inline std::atomic<unsigned long> & allocationCount()
+{
+	static std::atomic<unsigned long> count(0);
+	return count;
+}
+
+}
+
+// Every benchmark is a separate binary and this header is included by its only
+// translation unit, so global allocation functions are replaced right here.
+void * operator new(size_t size)
+{
+	++Bench::allocationCount();
+	void * result = malloc(size ? size : 1);
+	if(!result) {
+		throw std::bad_alloc();
+	}
+	return result;
+}
+
+void operator delete(void * ptr) noexcept
+{
+	free(ptr);
+}
+
+namespace Bench {
+
+// Measures time and allocations of the benchmarked code, setup can be excluded with pause()/resume().
+class Timer {
+public:
+	Timer() : elapsed(0), allocations(0), running(false) {}
+	void resume()
+	{
+		if(!running) {
+			running = true;
+			start_allocations = allocationCount();
+			start = std::chrono::steady_clock::now();
+		}
+	}
+	void pause()
+	{
+		if(running) {
+			elapsed += std::chrono::steady_clock::now() - start;
+			allocations += allocationCount() - start_allocations;
+			running = false;
+		}
+	}
+	double seconds() const { return std::chrono::duration<double>(elapsed).count(); }
+	unsigned long allocationsMade() const { return allocations; }
+private:
+	std::chrono::steady_clock::duration elapsed;
+	std::chrono::steady_clock::time_point start;
+	unsigned long allocations, start_allocations;
+	bool running;
+};
+
+struct Result {
+	std::string group, name;
+	unsigned long iterations;
+	double ns_per_op, allocations_per_op, ops_per_second;
+	// Zero when benchmark does not process data.
+	double mb_per_second;
+	// Benchmark-specific values, printed after the common ones.
+	std::vector<std::pair<std::string, double> > extra;
+};
+
+// Calls func(iterations, timer) with growing number of iterations until it runs for at least min_seconds.
+// bytes_per_op is used to report throughput in MB/s.
+template<class Func>
+Result run(const std::string & group, const std::string & name, Func func, size_t bytes_per_op = 0, double min_seconds = 0.2)
+{
+	for(unsigned long iterations = 1; ; iterations *= 2) {
+		Timer timer;
+		timer.resume();
+		func(iterations, timer);
+		timer.pause();
+		if(timer.seconds() < min_seconds && iterations < (1ul << 40)) {
+			continue;
+		}
+		Result result;
+		result.group = group;
+		result.name = name;
+		result.iterations = iterations;
+		result.ns_per_op = timer.seconds() * 1e9 / iterations;
+		result.allocations_per_op = double(timer.allocationsMade()) / iterations;
+		result.ops_per_second = iterations / timer.seconds();
+		result.mb_per_second = bytes_per_op * result.ops_per_second / (1024 * 1024);
+		return result;
+	}
+}
+
+// Writes results as JSON array, one object per line, so runs can be diffed and compared.
+inline void printJSON(std::ostream & out, const std::vector<Result> & results)
+{
+	out << "[\n";
+	for(unsigned i = 0; i < results.size(); ++i) {
+		const Result & result = results[i];
+		out << "{\"group\": \"" << result.group << "\""
+			<< ", \"name\": \"" << result.name << "\""
+			<< ", \"iterations\": " << result.iterations
+			<< ", \"ns_per_op\": " << result.ns_per_op
+			<< ", \"allocations_per_op\": " << result.allocations_per_op
+			<< ", \"ops_per_second\": " << result.ops_per_second;
+		if(result.mb_per_second > 0) {
+			out << ", \"mb_per_second\": " << result.mb_per_second;
+		}
+		for(const std::pair<std::string, double> & value : result.extra) {
+			out << ", \"" << value.first << "\": " << value.second;
+		}
+		out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "]" << std::endl;
+}
+
+}
+
+// Generates walled room of given size with randomly placed inner walls, boxes and slots.
+// Seed is fixed, so the same arguments always produce the same level.
+inline std::string generateLevel(int width, int height, int boxCount, unsigned seed = 1)
+{
+	srand(seed);
+	std::vector<std::string> rows(height, std::string(width, ' '));
+	for(int y = 0; y < height; ++y) {
+		for(int x = 0; x < width; ++x) {
+			bool border = x == 0 || y == 0 || x == width - 1 || y == height - 1;
+			if(border || rand() % 10 == 0) {
+				rows[y][x] = '#';
+			}
+		}
+	}
+	int free_cells = 0;
+	for(const std::string & row : rows) {
+		for(char ch : row) {
+			free_cells += (ch == ' ') ? 1 : 0;
+		}
+	}
+	// Player, and then pairs of box and slot.
+	int to_place = std::min(1 + boxCount * 2, free_cells);
+	for(int placed = 0; placed < to_place; ) {
+		int x = 1 + rand() % (width - 2);
+		int y = 1 + rand() % (height - 2);
+		if(rows[y][x] != ' ') {
+			continue;
+		}
+		rows[y][x] = (placed == 0) ? '@' : ((placed % 2) ? '$' : '.');
+		++placed;
+	}
+	std::string result;
+	for(const std::string & row : rows) {
+		result += row + '\n';
+	}
+	return result;
+}
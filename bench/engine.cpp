@@ -0,0 +1,158 @@
+#include "bench.h"
+#include "../src/sokoban.h"
+#include "../src/levelset.h"
+#include <iostream>
+
+namespace {
+
+const std::string SMALL_LEVEL =
+	"    #####          \n"
+	"    #   #          \n"
+	"    #$  #          \n"
+	"  ###  $##         \n"
+	"  #  $ $ #         \n"
+	"### # ## #   ######\n"
+	"#   # ## #####  ..#\n"
+	"# $  $          ..#\n"
+	"##### ### #@##  ..#\n"
+	"    #     #########\n"
+	"    #######        \n"
+	;
+
+const int DIRECTION_COUNT = 4096;
+
+std::vector<int> generateDirections()
+{
+	srand(1);
+	std::vector<int> result(DIRECTION_COUNT);
+	for(int & direction : result) {
+		direction = rand() % 4;
+	}
+	return result;
+}
+
+std::vector<Chthon::Point> collectFloorCells(const Sokoban & sokoban)
+{
+	std::vector<Chthon::Point> result;
+	for(int y = 0; y < sokoban.height(); ++y) {
+		for(int x = 0; x < sokoban.width(); ++x) {
+			Chthon::Point pos(x, y);
+			bool passable = sokoban.getCellAt(pos).type == Cell::FLOOR || sokoban.getCellAt(pos).type == Cell::SLOT;
+			if(passable && sokoban.getObjectAt(pos).isNull()) {
+				result.push_back(pos);
+			}
+		}
+	}
+	return result;
+}
+
+// Makes up to step_count successful moves, so there is something to undo.
+void walk(Sokoban & sokoban, const std::vector<int> & directions, unsigned long step_count)
+{
+	int failed_in_row = 0;
+	for(unsigned long i = 0, steps = 0; steps < step_count && failed_in_row < 4; ++i) {
+		if(sokoban.movePlayer(directions[i % directions.size()])) {
+			++steps;
+			failed_in_row = 0;
+		} else {
+			++failed_in_row;
+		}
+	}
+}
+
+void benchLevel(const std::string & group, const std::string & level, std::vector<Bench::Result> & results)
+{
+	static const std::vector<int> directions = generateDirections();
+	const Sokoban original(level);
+	const std::vector<Chthon::Point> targets = collectFloorCells(original);
+
+	results.push_back(Bench::run(group, "load", [&](unsigned long iterations, Bench::Timer &) {
+		for(unsigned long i = 0; i < iterations; ++i) {
+			Sokoban sokoban(level);
+		}
+	}, level.size()));
+
+	results.push_back(Bench::run(group, "movePlayer", [&](unsigned long iterations, Bench::Timer & timer) {
+		timer.pause();
+		Sokoban sokoban = original;
+		timer.resume();
+		for(unsigned long i = 0; i < iterations; ++i) {
+			sokoban.movePlayer(directions[i % directions.size()]);
+		}
+	}));
+
+	results.push_back(Bench::run(group, "undo", [&](unsigned long iterations, Bench::Timer & timer) {
+		timer.pause();
+		Sokoban sokoban = original;
+		walk(sokoban, directions, iterations);
+		timer.resume();
+		for(unsigned long i = 0; i < iterations; ++i) {
+			sokoban.undo();
+		}
+	}));
+
+	results.push_back(Bench::run(group, "isSolved", [&](unsigned long iterations, Bench::Timer &) {
+		volatile bool solved = false;
+		for(unsigned long i = 0; i < iterations; ++i) {
+			solved = original.isSolved();
+		}
+		(void)solved;
+	}));
+
+	results.push_back(Bench::run(group, "toString", [&](unsigned long iterations, Bench::Timer &) {
+		for(unsigned long i = 0; i < iterations; ++i) {
+			original.toString();
+		}
+	}));
+
+	if(!targets.empty()) {
+		results.push_back(Bench::run(group, "goto", [&](unsigned long iterations, Bench::Timer & timer) {
+			timer.pause();
+			Sokoban sokoban = original;
+			timer.resume();
+			// Targets are taken in scan order from both ends, so paths cross the whole level.
+			for(unsigned long i = 0; i < iterations; ++i) {
+				size_t index = (i * 7919) % targets.size();
+				sokoban.movePlayer(targets[(i % 2) ? index : targets.size() - 1 - index]);
+			}
+		}));
+	}
+}
+
+}
+
+// Measures core engine operations on small level, generated huge level
+// and on the largest level of levelset given as the first argument.
+// Results are printed to stdout as JSON.
+int main(int argc, char ** argv)
+{
+	std::vector<Bench::Result> results;
+	benchLevel("small", SMALL_LEVEL, results);
+	benchLevel("generated_100x100", generateLevel(100, 100, 250), results);
+
+	if(argc > 1) {
+		LevelSet levelSet;
+		if(!levelSet.loadFromFile(argv[1], 0)) {
+			std::cerr << "Cannot load levelset: " << argv[1] << std::endl;
+			return 1;
+		}
+		int largest = -1, largest_area = 0;
+		for(int i = 0; i < levelSet.getLevelCount(); ++i) {
+			try {
+				Sokoban sokoban = levelSet.getSokoban(i);
+				if(sokoban.width() * sokoban.height() > largest_area) {
+					largest_area = sokoban.width() * sokoban.height();
+					largest = i;
+				}
+			} catch(const Sokoban::InvalidPlayerCountException & e) {
+			}
+		}
+		if(largest >= 0) {
+			std::string group = "levelset_" + std::to_string(largest + 1);
+			benchLevel(group, levelSet.getSokoban(largest).toString(), results);
+		}
+	}
+
+	Bench::printJSON(std::cout, results);
+	return 0;
+}
@@ -0,0 +1,142 @@
+#include "bench.h"
+#include "../src/levelset.h"
+#include <chthon2/format.h>
+#include <sys/resource.h>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+namespace {
+
+struct Corpus {
+	int level_count;
+	int width, height, box_count;
+};
+
+// Goes from smaller files to larger ones, so peak RSS after every case is dominated by that case.
+const Corpus CORPORA[] = {
+	{ 10, 10, 8, 3 },
+	{ 10, 30, 20, 20 },
+	{ 10, 100, 100, 250 },
+	{ 1000, 10, 8, 3 },
+	{ 1000, 30, 20, 20 },
+	{ 10000, 30, 20, 20 },
+	{ 1000, 100, 100, 250 },
+	{ 100000, 10, 8, 3 },
+};
+
+std::string corpusFileName(const Corpus & corpus)
+{
+	return Chthon::format("tmp/bench/levelset_{0}_{1}x{2}.slc", corpus.level_count, corpus.width, corpus.height);
+}
+
+// Writes levelset in the same format as real collections, existing files are reused.
+bool generateCorpus(const Corpus & corpus, const std::string & file_name)
+{
+	if(std::ifstream(file_name.c_str())) {
+		return true;
+	}
+	std::ofstream out(file_name.c_str());
+	out << "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n";
+	out << "<SokobanLevels>\n";
+	out << "  <Title>Generated</Title>\n";
+	out << Chthon::format("  <LevelCollection Copyright=\"Miniban\" MaxWidth=\"{0}\" MaxHeight=\"{1}\">\n", corpus.width, corpus.height);
+	for(int i = 0; i < corpus.level_count; ++i) {
+		out << Chthon::format("    <Level Id=\"{0}\" Width=\"{1}\" Height=\"{2}\">\n", i + 1, corpus.width, corpus.height);
+		std::istringstream level(generateLevel(corpus.width, corpus.height, corpus.box_count, i + 1));
+		std::string row;
+		while(std::getline(level, row)) {
+			out << "      <L>" << row << "</L>\n";
+		}
+		out << "    </Level>\n";
+	}
+	out << "  </LevelCollection>\n";
+	out << "</SokobanLevels>\n";
+	return bool(out);
+}
+
+std::string readFile(const std::string & file_name)
+{
+	std::ifstream file(file_name.c_str(), std::ifstream::in);
+	return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+}
+
+long peakRSSKilobytes()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+void benchCorpus(const Corpus & corpus, std::vector<Bench::Result> & results)
+{
+	std::string file_name = corpusFileName(corpus);
+	if(!generateCorpus(corpus, file_name)) {
+		std::cerr << "Cannot write corpus file: " << file_name << std::endl;
+		return;
+	}
+	std::string group = Chthon::format("{0}_levels_{1}x{2}", corpus.level_count, corpus.width, corpus.height);
+	size_t file_size = readFile(file_name).size();
+
+	// Time to first level is what player waits for at startup: reading, parsing and loading of the first level.
+	Bench::Result load = Bench::run(group, "loadFromFile", [&](unsigned long iterations, Bench::Timer &) {
+		for(unsigned long i = 0; i < iterations; ++i) {
+			LevelSet levelSet;
+			levelSet.loadFromFile(file_name, 0);
+		}
+	}, file_size);
+	load.extra.push_back(std::make_pair("time_to_first_level_ms", load.ns_per_op / 1e6));
+	results.push_back(load);
+
+	std::string content = readFile(file_name);
+	results.push_back(Bench::run(group, "loadFromString", [&](unsigned long iterations, Bench::Timer &) {
+		for(unsigned long i = 0; i < iterations; ++i) {
+			LevelSet levelSet;
+			levelSet.loadFromString(content, 0);
+		}
+	}, content.size()));
+
+	results.push_back(Bench::run(group, "moveToNextLevel", [&](unsigned long iterations, Bench::Timer & timer) {
+		timer.pause();
+		LevelSet levelSet;
+		levelSet.loadFromString(content, 0);
+		timer.resume();
+		for(unsigned long i = 0; i < iterations; ++i) {
+			if(!levelSet.moveToNextLevel()) {
+				timer.pause();
+				levelSet = LevelSet();
+				levelSet.loadFromString(content, 0);
+				timer.resume();
+			}
+		}
+	}));
+
+	results.push_back(Bench::run(group, "rewindToLevel", [&](unsigned long iterations, Bench::Timer & timer) {
+		timer.pause();
+		LevelSet levelSet;
+		levelSet.loadFromString(content, 0);
+		timer.resume();
+		// Jumps to arbitrary level, the way level selection does.
+		for(unsigned long i = 0; i < iterations; ++i) {
+			levelSet.rewindToLevel((i * 7919) % corpus.level_count);
+			levelSet.moveToNextLevel();
+		}
+	}));
+
+	results.back().extra.push_back(std::make_pair("peak_rss_kb", double(peakRSSKilobytes())));
+}
+
+}
+
+// Loads generated levelsets from 10 to 100000 levels of different sizes.
+// Corpus is written to tmp/bench/ on the first run and reused later.
+// Results are printed to stdout as JSON.
+int main()
+{
+	std::vector<Bench::Result> results;
+	for(const Corpus & corpus : CORPORA) {
+		benchCorpus(corpus, results);
+	}
+	Bench::printJSON(std::cout, results);
+	return 0;
+}
@@ -0,0 +1,54 @@
+#include "bench.h"
+#include "../src/playingmode.h"
+#include "../src/spritebatch.h"
+#include <chthon2/format.h>
+#include <SDL2/SDL.h>
+#include <iostream>
+
+// Renders generated 100x100 level into off-screen software renderer,
+// once with per-sprite copies and once with batched geometry.
+int main()
+{
+	const int FRAME_COUNT = 200;
+	SDL_Rect rect = { 0, 0, 1920, 1080 };
+	SDL_Surface * surface = SDL_CreateRGBSurface(0, rect.w, rect.h, 32,
+			0x00ff0000,
+			0x0000ff00,
+			0x000000ff,
+			0xff000000
+			);
+	SDL_Renderer * renderer = SDL_CreateSoftwareRenderer(surface);
+	if(!renderer) {
+		std::cerr << SDL_GetError() << std::endl;
+		return 1;
+	}
+	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+	Sprites sprites;
+	sprites.init(renderer);
+	Sokoban sokoban(generateLevel(100, 100, 200));
+	std::shared_ptr<const LevelMap> level_map = std::make_shared<LevelMap>(sokoban);
+
+	const bool modes[] = { false, true };
+	for(bool geometry : modes) {
+		SpriteBatch::setGeometryEnabled(geometry);
+		Game game(sokoban, level_map, sprites);
+		game.paint(renderer, rect);
+
+		SpriteBatch::resetDrawCallCount();
+		Uint64 start = SDL_GetPerformanceCounter();
+		for(int i = 0; i < FRAME_COUNT; ++i) {
+			game.paint(renderer, rect);
+		}
+		Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+		double frame_usec = 1000000.0 * elapsed / SDL_GetPerformanceFrequency() / FRAME_COUNT;
+		std::cout << Chthon::format("{0}: {1} draw calls/frame, {2} usec/frame",
+				geometry ? "batched" : "per-sprite",
+				SpriteBatch::getDrawCallCount() / FRAME_COUNT,
+				int(frame_usec)
+				) << std::endl;
+	}
+
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(surface);
+	return 0;
+}
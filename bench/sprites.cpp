@@ -0,0 +1,54 @@
+#include "../src/sprites.h"
+#include <chthon2/pixmap.h>
+#include <chthon2/format.h>
+#include <chthon2/util.h>
+#include <SDL2/SDL.h>
+#include <iostream>
+
+namespace Xpm {
+#include "../res/sokoban.xpm"
+#include "../res/font.xpm"
+}
+
+// Compares runtime XPM parsing (how sprites used to be loaded)
+// with uploading of baked pixel arrays by Sprites::init.
+int main()
+{
+	const int RUN_COUNT = 20;
+	SDL_Surface * surface = SDL_CreateRGBSurface(0, 64, 64, 32,
+			0x00ff0000,
+			0x0000ff00,
+			0x000000ff,
+			0xff000000
+			);
+	SDL_Renderer * renderer = SDL_CreateSoftwareRenderer(surface);
+	if(!renderer) {
+		std::cerr << SDL_GetError() << std::endl;
+		return 1;
+	}
+
+	Uint64 start = SDL_GetPerformanceCounter();
+	for(int i = 0; i < RUN_COUNT; ++i) {
+		Chthon::Pixmap sokoban, font;
+		sokoban.load(std::vector<std::string>(Xpm::sokoban, Xpm::sokoban + Chthon::size_of_array(Xpm::sokoban)));
+		font.load(std::vector<std::string>(Xpm::font, Xpm::font + Chthon::size_of_array(Xpm::font)));
+	}
+	Uint64 xpm_time = SDL_GetPerformanceCounter() - start;
+
+	start = SDL_GetPerformanceCounter();
+	for(int i = 0; i < RUN_COUNT; ++i) {
+		Sprites sprites;
+		sprites.init(renderer);
+		SDL_DestroyTexture(sprites.getTileSet());
+		SDL_DestroyTexture(sprites.getFont());
+	}
+	Uint64 baked_time = SDL_GetPerformanceCounter() - start;
+
+	double usec = 1000000.0 / SDL_GetPerformanceFrequency() / RUN_COUNT;
+	std::cout << Chthon::format("XPM parsing only: {0} usec", int(xpm_time * usec)) << std::endl;
+	std::cout << Chthon::format("Sprites::init with baked atlases: {0} usec", int(baked_time * usec)) << std::endl;
+
+	SDL_DestroyRenderer(renderer);
+	SDL_FreeSurface(surface);
+	return 0;
+}
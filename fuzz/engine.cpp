@@ -0,0 +1,205 @@
+#include "reference.h"
+#include "../src/sokoban.h"
+#include <chthon2/format.h>
+#include <random>
+#include <memory>
+#include <chrono>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+namespace {
+
+const int STEPS_PER_CASE = 200;
+
+// Small ragged levels without guaranteed outer walls, so bounds checks are exercised too.
+std::string generateLevel(std::mt19937 & random)
+{
+	int width = 2 + random() % 9;
+	int height = 1 + random() % 8;
+	std::vector<std::string> rows(height);
+	for(std::string & row : rows) {
+		int row_width = (random() % 4 == 0) ? 1 + random() % width : width;
+		for(int x = 0; x < row_width; ++x) {
+			int chance = random() % 100;
+			row += (chance < 25) ? '#' : ((chance < 75) ? ' ' : ((chance < 85) ? '$' : ((chance < 95) ? '.' : '*')));
+		}
+	}
+	// Rarely level gets wrong number of players, both engines should reject it.
+	int player_count = (random() % 64 == 0) ? random() % 3 : 1;
+	for(int i = 0; i < player_count; ++i) {
+		std::string & row = rows[random() % height];
+		char & cell = row[random() % row.size()];
+		cell = (cell == '.' || cell == '*') ? '+' : '@';
+	}
+	std::string result;
+	for(unsigned y = 0; y < rows.size(); ++y) {
+		result += rows[y] + ((y + 1 < rows.size()) ? "\n" : "");
+	}
+	return result;
+}
+
+// Background history is usually empty, but sometimes it is garbage, to check InvalidUndoException paths.
+std::string generateHistory(std::mt19937 & random)
+{
+	if(random() % 4 != 0) {
+		return std::string();
+	}
+	const std::string STEPS = "lrudLRUD-x";
+	std::string result(random() % 6, ' ');
+	for(char & step : result) {
+		step = STEPS[random() % STEPS.size()];
+	}
+	return result;
+}
+
+struct Mismatch {
+	std::string what;
+};
+
+template<class T>
+void compare(const std::string & what, const T & expected, const T & actual)
+{
+	if(!(expected == actual)) {
+		std::ostringstream out;
+		out << what << ": reference gives <" << expected << ">, engine gives <" << actual << ">";
+		throw Mismatch{out.str()};
+	}
+}
+
+void compareState(const ReferenceEngine & reference, const Sokoban & sokoban)
+{
+	compare("toString", reference.toString(), sokoban.toString());
+	compare("historyAsString", reference.historyAsString(), sokoban.historyAsString());
+	compare("isSolved", reference.isSolved(), sokoban.isSolved());
+	compare("player x", reference.playerX(), sokoban.getPlayerPos().x);
+	compare("player y", reference.playerY(), sokoban.getPlayerPos().y);
+}
+
+// Calls the same operation on both engines, results and thrown exceptions must match.
+template<class ReferenceOp, class EngineOp>
+void compareResults(const std::string & what, ReferenceOp referenceOp, EngineOp engineOp)
+{
+	std::string expected, actual;
+	try {
+		expected = referenceOp() ? "true" : "false";
+	} catch(const ReferenceEngine::InvalidUndo & e) {
+		expected = Chthon::format("InvalidUndoException({0})", e.control);
+	}
+	try {
+		actual = engineOp() ? "true" : "false";
+	} catch(const Sokoban::InvalidUndoException & e) {
+		actual = Chthon::format("InvalidUndoException({0})", e.invalidUndoControl);
+	}
+	compare(what, expected, actual);
+}
+
+// Returns number of performed steps.
+int runCase(unsigned seed, std::string & log)
+{
+	std::mt19937 random(seed);
+	std::string level = generateLevel(random);
+	std::string background = generateHistory(random);
+	bool full_history = random() % 2;
+	log = Chthon::format("level:\n{0}\nbackground history: '{1}', full history: {2}\n", level, background, full_history);
+
+	int expected_players = 1, actual_players = 1;
+	std::unique_ptr<ReferenceEngine> reference;
+	try {
+		reference.reset(new ReferenceEngine(level, background, full_history));
+	} catch(const ReferenceEngine::InvalidPlayerCount & e) {
+		expected_players = e.count;
+	}
+	Sokoban sokoban;
+	try {
+		sokoban.load(level, background, full_history);
+	} catch(const Sokoban::InvalidPlayerCountException & e) {
+		actual_players = e.playerCount;
+	}
+	compare("player count", expected_players, actual_players);
+	if(!reference) {
+		return 0;
+	}
+	compareState(*reference, sokoban);
+
+	for(int i = 0; i < STEPS_PER_CASE; ++i) {
+		int op = random() % 100;
+		// Control 8 is out of range and should be ignored.
+		int control = random() % 9;
+		if(op < 50) {
+			bool cautious = random() % 4 == 0;
+			log += Chthon::format("movePlayer({0}, {1})\n", control, cautious);
+			compareResults("movePlayer",
+					[&]() { return reference->movePlayer(control, cautious); },
+					[&]() { return sokoban.movePlayer(control, cautious); }
+					);
+		} else if(op < 60) {
+			log += Chthon::format("runPlayer({0})\n", control);
+			compareResults("runPlayer",
+					[&]() { return reference->runPlayer(control); },
+					[&]() { return sokoban.runPlayer(control); }
+					);
+		} else if(op < 87) {
+			log += "undo()\n";
+			compareResults("undo",
+					[&]() { return reference->undo(); },
+					[&]() { return sokoban.undo(); }
+					);
+		} else if(op < 90) {
+			log += "restart()\n";
+			compareResults("restart",
+					[&]() { reference->restart(); return true; },
+					[&]() { sokoban.restart(); return true; }
+					);
+		} else {
+			// Path may be chosen differently, so only its length is compared and then replayed on reference.
+			int x = random() % reference->width();
+			int y = random() % reference->height();
+			bool is_player = x == reference->playerX() && y == reference->playerY();
+			if(is_player || reference->cellAt(x, y) == ReferenceEngine::WALL || reference->hasBox(x, y)) {
+				continue;
+			}
+			log += Chthon::format("goto({0}, {1})\n", x, y);
+			int distance = reference->distanceTo(x, y);
+			std::string history_before = sokoban.historyAsString();
+			bool found = sokoban.movePlayer(Chthon::Point(x, y));
+			compare("goto", distance >= 0, found);
+			std::string path = sokoban.historyAsString().substr(history_before.size());
+			compare("goto path length", distance >= 0 ? distance : 0, int(path.size()));
+			for(char step : path) {
+				compare("goto path step", true, reference->applyStep(step));
+			}
+		}
+		compareState(*reference, sokoban);
+	}
+	return STEPS_PER_CASE;
+}
+
+}
+
+// Runs random control sequences on random levels through both reference model and Sokoban,
+// compares their state after every step. Stops at the first mismatch and prints the case.
+// Usage: miniban_fuzz_engine [seconds] [seed]
+int main(int argc, char ** argv)
+{
+	int seconds = (argc > 1) ? atoi(argv[1]) : 10;
+	unsigned seed = (argc > 2) ? strtoul(argv[2], 0, 10) : std::random_device()();
+	std::cout << "Seed: " << seed << std::endl;
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point finish = Clock::now() + std::chrono::seconds(seconds);
+	long long steps = 0;
+	unsigned cases = 0;
+	for(; Clock::now() < finish; ++cases) {
+		std::string log;
+		try {
+			steps += runCase(seed + cases, log);
+		} catch(const Mismatch & e) {
+			std::cout << "Mismatch in case " << (seed + cases) << ": " << e.what << std::endl;
+			std::cout << log;
+			return 1;
+		}
+	}
+	std::cout << Chthon::format("{0} cases, {1} steps, no mismatches.", cases, steps) << std::endl;
+	return 0;
+}
@@ -0,0 +1,288 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cctype>
+
+// Straightforward model of Sokoban rules, written independently from src/sokoban.cpp
+// and without regard to speed: flat char grid, plain BFS, explicit stack of steps.
+// Differential fuzzer compares production engine with it after every step.
+class ReferenceEngine {
+public:
+	enum { LEFT, RIGHT, DOWN, UP, UP_LEFT, UP_RIGHT, DOWN_LEFT, DOWN_RIGHT };
+	enum { SPACE = ' ', FLOOR = '_', WALL = '#', SLOT = '.' };
+
+	// Same as exceptions of Sokoban, but carry only data that is compared.
+	struct InvalidPlayerCount { int count; };
+	struct InvalidUndo { char control; };
+
+	ReferenceEngine(const std::string & level, const std::string & background_history, bool full_history);
+
+	bool movePlayer(int control, bool cautious = false);
+	bool runPlayer(int control);
+	bool undo();
+	void restart() { while(undo()) {} }
+	// Returns length of the shortest box-free path, or -1 when target is unreachable.
+	int distanceTo(int x, int y) const;
+	// Applies plain step char as it is written to history.
+	bool applyStep(char step);
+
+	std::string toString() const;
+	const std::string & historyAsString() const { return history; }
+	bool isSolved() const;
+	int playerX() const { return player_x; }
+	int playerY() const { return player_y; }
+	int width() const { return w; }
+	int height() const { return h; }
+	char cellAt(int x, int y) const { return cells[y * w + x]; }
+	bool hasBox(int x, int y) const { return inside(x, y) && boxes[y * w + x]; }
+private:
+	int w, h;
+	std::vector<char> cells;
+	std::vector<bool> boxes;
+	int player_x, player_y;
+	std::string history;
+	bool full_history;
+	// Steps that can be undone, the latest is at the end.
+	std::string steps;
+
+	bool inside(int x, int y) const { return 0 <= x && x < w && 0 <= y && y < h; }
+	bool passable(int x, int y) const { return inside(x, y) && cellAt(x, y) != WALL; }
+	bool step(int direction, bool cautious);
+	static void shift(int direction, int & dx, int & dy);
+};
+
+inline ReferenceEngine::ReferenceEngine(const std::string & level, const std::string & background_history, bool full_history_tracking)
+	: w(0), h(0), player_x(-1), player_y(-1), history(background_history), full_history(full_history_tracking)
+{
+	std::vector<std::string> rows(1);
+	for(char ch : level) {
+		if(ch == '\n') {
+			rows.push_back(std::string());
+		} else {
+			rows.back() += ch;
+		}
+	}
+	if(rows.size() > 1 && rows.back().empty()) {
+		rows.pop_back();
+	}
+	h = rows.size();
+	for(const std::string & row : rows) {
+		w = std::max(w, int(row.size()));
+	}
+	cells.assign(w * h, SPACE);
+	boxes.assign(w * h, false);
+	int player_count = 0;
+	for(int y = 0; y < h; ++y) {
+		for(int x = 0; x < int(rows[y].size()); ++x) {
+			char ch = rows[y][x];
+			cells[y * w + x] = (ch == '#') ? WALL : ((ch == '.' || ch == '*' || ch == '+') ? SLOT : SPACE);
+			boxes[y * w + x] = (ch == '$' || ch == '*');
+			if(ch == '@' || ch == '+') {
+				player_x = x;
+				player_y = y;
+				++player_count;
+			}
+		}
+	}
+	if(player_count != 1) {
+		throw InvalidPlayerCount{player_count};
+	}
+
+	// Empty cells that player can reach are floor, the rest stay outer space.
+	std::vector<bool> visited(w * h, false);
+	std::deque<int> queue(1, player_y * w + player_x);
+	visited[queue.front()] = true;
+	while(!queue.empty()) {
+		int x = queue.front() % w, y = queue.front() / w;
+		queue.pop_front();
+		if(cells[y * w + x] == SPACE) {
+			cells[y * w + x] = FLOOR;
+		}
+		for(int direction = LEFT; direction <= UP; ++direction) {
+			int dx, dy;
+			shift(direction, dx, dy);
+			if(passable(x + dx, y + dy) && !visited[(y + dy) * w + x + dx]) {
+				visited[(y + dy) * w + x + dx] = true;
+				queue.push_back((y + dy) * w + x + dx);
+			}
+		}
+	}
+
+	for(char ch : history) {
+		if(ch == '-' && full_history) {
+			if(!steps.empty()) {
+				steps.erase(steps.size() - 1);
+			}
+		} else {
+			steps += ch;
+		}
+	}
+}
+
+inline void ReferenceEngine::shift(int direction, int & dx, int & dy)
+{
+	dx = (direction == LEFT) ? -1 : ((direction == RIGHT) ? 1 : 0);
+	dy = (direction == UP) ? -1 : ((direction == DOWN) ? 1 : 0);
+}
+
+inline bool ReferenceEngine::step(int direction, bool cautious)
+{
+	int dx, dy;
+	shift(direction, dx, dy);
+	int x = player_x + dx, y = player_y + dy;
+	if(!passable(x, y)) {
+		return false;
+	}
+	bool push = hasBox(x, y);
+	if(push && (cautious || !passable(x + dx, y + dy) || hasBox(x + dx, y + dy))) {
+		return false;
+	}
+	if(push) {
+		boxes[y * w + x] = false;
+		boxes[(y + dy) * w + x + dx] = true;
+	}
+	player_x = x;
+	player_y = y;
+	char ch = "lrdu"[direction];
+	ch = push ? toupper(ch) : ch;
+	history += ch;
+	steps += ch;
+	return true;
+}
+
+inline bool ReferenceEngine::movePlayer(int control, bool cautious)
+{
+	if(LEFT <= control && control <= UP) {
+		return step(control, cautious);
+	}
+	if(control < UP_LEFT || DOWN_RIGHT < control) {
+		return false;
+	}
+	// Diagonal move is two cautious steps, vertical one is tried first.
+	int vertical = (control == UP_LEFT || control == UP_RIGHT) ? UP : DOWN;
+	int horizontal = (control == UP_LEFT || control == DOWN_LEFT) ? LEFT : RIGHT;
+	if(step(vertical, true)) {
+		if(step(horizontal, true)) {
+			return true;
+		}
+		undo();
+		return false;
+	}
+	if(step(horizontal, true)) {
+		if(step(vertical, true)) {
+			return true;
+		}
+		undo();
+	}
+	return false;
+}
+
+inline bool ReferenceEngine::runPlayer(int control)
+{
+	bool moved = false;
+	while(movePlayer(control, true)) {
+		moved = true;
+	}
+	return moved;
+}
+
+inline bool ReferenceEngine::applyStep(char ch)
+{
+	const std::string STEPS = "lrdu";
+	size_t direction = STEPS.find(tolower(ch));
+	return direction != std::string::npos && step(direction, false);
+}
+
+inline bool ReferenceEngine::undo()
+{
+	if(steps.empty()) {
+		return false;
+	}
+	char control = steps[steps.size() - 1];
+	const std::string STEPS = "lrdu";
+	size_t direction = STEPS.find(tolower(control));
+	if(direction == std::string::npos) {
+		throw InvalidUndo{control};
+	}
+	int dx, dy;
+	shift(direction, dx, dy);
+	int old_x = player_x - dx, old_y = player_y - dy;
+	if(!passable(old_x, old_y) || hasBox(old_x, old_y)) {
+		throw InvalidUndo{control};
+	}
+	bool push = isupper(control);
+	if(push && !hasBox(player_x + dx, player_y + dy)) {
+		throw InvalidUndo{control};
+	}
+	if(push) {
+		boxes[(player_y + dy) * w + player_x + dx] = false;
+		boxes[player_y * w + player_x] = true;
+	}
+	player_x = old_x;
+	player_y = old_y;
+	steps.erase(steps.size() - 1);
+	if(full_history) {
+		history += '-';
+	} else {
+		history.erase(history.size() - 1);
+	}
+	return true;
+}
+
+inline int ReferenceEngine::distanceTo(int target_x, int target_y) const
+{
+	std::vector<int> distance(w * h, -1);
+	std::deque<int> queue(1, player_y * w + player_x);
+	distance[queue.front()] = 0;
+	while(!queue.empty()) {
+		int x = queue.front() % w, y = queue.front() / w;
+		queue.pop_front();
+		if(x == target_x && y == target_y) {
+			return distance[y * w + x];
+		}
+		for(int direction = LEFT; direction <= UP; ++direction) {
+			int dx, dy;
+			shift(direction, dx, dy);
+			int next = (y + dy) * w + x + dx;
+			if(passable(x + dx, y + dy) && !hasBox(x + dx, y + dy) && distance[next] < 0) {
+				distance[next] = distance[y * w + x] + 1;
+				queue.push_back(next);
+			}
+		}
+	}
+	return -1;
+}
+
+inline std::string ReferenceEngine::toString() const
+{
+	std::string result;
+	for(int y = 0; y < h; ++y) {
+		for(int x = 0; x < w; ++x) {
+			bool is_player = x == player_x && y == player_y;
+			bool is_box = hasBox(x, y);
+			switch(cellAt(x, y)) {
+				case SPACE: result += ' '; break;
+				case WALL: result += '#'; break;
+				case FLOOR: result += is_player ? '@' : (is_box ? '$' : ' '); break;
+				case SLOT: result += is_player ? '+' : (is_box ? '*' : '.'); break;
+			}
+		}
+		if(y != h - 1) {
+			result += '\n';
+		}
+	}
+	return result;
+}
+
+inline bool ReferenceEngine::isSolved() const
+{
+	int slot_count = 0, box_count = 0, boxes_on_slots = 0;
+	for(int i = 0; i < w * h; ++i) {
+		slot_count += (cells[i] == SLOT) ? 1 : 0;
+		box_count += boxes[i] ? 1 : 0;
+		boxes_on_slots += (boxes[i] && cells[i] == SLOT) ? 1 : 0;
+	}
+	return boxes_on_slots == box_count && boxes_on_slots == slot_count;
+}
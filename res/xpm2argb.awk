@@ -0,0 +1,61 @@
+# Converts XPM image into C header with ARGB8888 pixel array.
+# Array and size constants are named after XPM variable.
+# Usage: awk -f xpm2argb.awk image.xpm > image_pixels.h
+
+function hexvalue(str,    result, i) {
+	result = 0
+	for(i = 1; i <= length(str); ++i) {
+		result = result * 16 + index("0123456789abcdef", tolower(substr(str, i, 1))) - 1
+	}
+	return result
+}
+
+/^static/ {
+	name = $0
+	sub(/.*\*/, "", name)
+	sub(/\[.*/, "", name)
+	next
+}
+
+/^"/ {
+	line = $0
+	sub(/^"/, "", line)
+	sub(/",?[ \t]*$/, "", line)
+	++strings
+	if(strings == 1) {
+		split(line, header, " ")
+		width = header[1]; height = header[2]; colors = header[3]; cpp = header[4]
+		printf("/* Generated from %s, do not edit. */\n", FILENAME)
+		printf("static const unsigned %s_width = %d;\n", name, width)
+		printf("static const unsigned %s_height = %d;\n", name, height)
+		printf("static const unsigned int %s_pixels[] = {\n", name)
+		next
+	}
+	if(strings <= 1 + colors) {
+		key = substr(line, 1, cpp)
+		count = split(substr(line, cpp + 1), tokens, " ")
+		palette[key] = "0x00000000"
+		for(i = 1; i < count; ++i) {
+			if(tokens[i] == "c") {
+				if(tolower(tokens[i + 1]) != "none") {
+					palette[key] = sprintf("0xff%06x", hexvalue(substr(tokens[i + 1], 2)))
+				}
+				break
+			}
+		}
+		next
+	}
+	out = "\t"
+	for(x = 0; x < width; ++x) {
+		out = out palette[substr(line, x * cpp + 1, cpp)] ","
+		if(x % 8 == 7 && x + 1 < width) {
+			print out
+			out = "\t"
+		}
+	}
+	print out
+}
+
+END {
+	print "};"
+}
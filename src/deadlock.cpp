@@ -0,0 +1,149 @@
+#include "deadlock.h"
+#include "sokoban.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+long long now()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+}
+
+DeadlockDetector::DeadlockDetector()
+	: map(new LevelMap()), player(LevelMap::NO_CELL), pushes(0), deadline(0), budget_exceeded(false)
+{
+}
+
+void DeadlockDetector::setLevel(const Sokoban & sokoban)
+{
+	setLevel(sokoban, std::make_shared<LevelMap>(sokoban));
+}
+
+void DeadlockDetector::setLevel(const Sokoban & sokoban, const std::shared_ptr<const LevelMap> & level_map)
+{
+	map = level_map;
+	as_wall.assign(map->getCellCount(), 0);
+	setPosition(sokoban);
+}
+
+void DeadlockDetector::setPosition(const Sokoban & sokoban)
+{
+	boxes.assign(map->getCellCount(), 0);
+	for(const Object & box : sokoban.getBoxes()) {
+		boxes[map->getCellIndex(box.pos)] = 1;
+	}
+	player = map->getCellIndex(sokoban.getPlayerPos());
+	pushes = sokoban.getHistoryPushes();
+}
+
+// Walks do not move boxes. Push moves the box from the player's new cell one step further,
+// undo of push moves it from behind the player's old cell back to it.
+void DeadlockDetector::syncBoxes(const Sokoban & sokoban)
+{
+	int new_player = map->getCellIndex(sokoban.getPlayerPos());
+	int new_pushes = sokoban.getHistoryPushes();
+	if(new_pushes == pushes) {
+		player = new_player;
+		return;
+	}
+	int from = LevelMap::NO_CELL, to = LevelMap::NO_CELL;
+	for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+		if(player == LevelMap::NO_CELL || map->getNeighbour(player, direction) != new_player) {
+			continue;
+		}
+		if(new_pushes == pushes + 1) {
+			from = new_player;
+			to = map->getNeighbour(new_player, direction);
+		} else if(new_pushes == pushes - 1) {
+			from = map->getNeighbour(player, LevelMap::opposite(direction));
+			to = player;
+		}
+	}
+	if(from == LevelMap::NO_CELL || to == LevelMap::NO_CELL || !boxes[from] || boxes[to]) {
+		setPosition(sokoban);
+		return;
+	}
+	boxes[from] = 0;
+	boxes[to] = 1;
+	player = new_player;
+	pushes = new_pushes;
+}
+
+// Box is blocked along the axis of direction if it cannot be pushed either way.
+bool DeadlockDetector::isBlocked(int cell, int direction)
+{
+	int first = map->getNeighbour(cell, direction);
+	int second = map->getNeighbour(cell, LevelMap::opposite(direction));
+	if(first == LevelMap::NO_CELL || second == LevelMap::NO_CELL || as_wall[first] || as_wall[second]) {
+		return true;
+	}
+	if(map->isDead(first) && map->isDead(second)) {
+		return true;
+	}
+	return (boxes[first] && isFrozen(first)) || (boxes[second] && isFrozen(second));
+}
+
+bool DeadlockDetector::isFrozen(int cell)
+{
+	if(now() > deadline) {
+		budget_exceeded = true;
+		return false;
+	}
+	as_wall[cell] = 1;
+	walled.push_back(cell);
+	bool result = isBlocked(cell, Sokoban::LEFT) && isBlocked(cell, Sokoban::UP);
+	if(result) {
+		frozen.push_back(cell);
+	}
+	return result;
+}
+
+std::vector<Chthon::Point> DeadlockDetector::check(const Sokoban & sokoban, const std::vector<Chthon::Point> & boxes_to_check, long long budget_nsec)
+{
+	syncBoxes(sokoban);
+	// Budget is for the check itself.
+	deadline = now() + budget_nsec;
+	budget_exceeded = false;
+
+	std::vector<int> dead;
+	for(const Chthon::Point & pos : boxes_to_check) {
+		int cell = map->getCellIndex(pos);
+		if(cell == LevelMap::NO_CELL || !boxes[cell] || std::find(dead.begin(), dead.end(), cell) != dead.end()) {
+			continue;
+		}
+		if(map->isDead(cell)) {
+			dead.push_back(cell);
+			continue;
+		}
+		frozen.clear();
+		bool is_frozen = isFrozen(cell);
+		for(int box : walled) {
+			as_wall[box] = 0;
+		}
+		walled.clear();
+		if(!is_frozen || budget_exceeded) {
+			continue;
+		}
+		// Frozen boxes on goals are fine, unless some box of the same group is not on goal.
+		std::vector<int> off_goals;
+		for(int box : frozen) {
+			if(!map->isGoal(box)) {
+				off_goals.push_back(box);
+			}
+		}
+		for(int box : off_goals) {
+			if(std::find(dead.begin(), dead.end(), box) == dead.end()) {
+				dead.push_back(box);
+			}
+		}
+	}
+
+	std::vector<Chthon::Point> result;
+	for(int cell : dead) {
+		result.push_back(map->getCellPos(cell));
+	}
+	return result;
+}
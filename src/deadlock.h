@@ -0,0 +1,44 @@
+#pragma once
+#include "levelmap.h"
+#include <chthon2/point.h>
+#include <memory>
+#include <vector>
+class Sokoban;
+
+// Cheap check of the position around moved boxes, made after every move in game.
+// Box is dead when it is on a cell from which it can never reach a goal,
+// or when it is frozen (cannot move along both axes because of walls, dead cells and other frozen boxes,
+// e.g. 2x2 block of boxes) together with boxes that are not on goals.
+// Only boxes connected to the checked ones are examined, and the check stops when time budget is spent,
+// so it may miss a deadlock but never reports a false one.
+// Box cells are kept between checks: a push or its undo (seen by the pushes counter of Sokoban and the player's step)
+// moves one box, so check should follow every move; other jumps of position, like restart, go through setPosition().
+class DeadlockDetector {
+public:
+	enum { DEFAULT_BUDGET_NSEC = 200000 };
+
+	DeadlockDetector();
+	void setLevel(const Sokoban & sokoban);
+	// The same with map that was already built for the level, e.g. by LevelSet.
+	void setLevel(const Sokoban & sokoban, const std::shared_ptr<const LevelMap> & level_map);
+	void setPosition(const Sokoban & sokoban);
+	// Returns positions of dead boxes among given ones and boxes frozen together with them.
+	std::vector<Chthon::Point> check(const Sokoban & sokoban, const std::vector<Chthon::Point> & boxes_to_check, long long budget_nsec = DEFAULT_BUDGET_NSEC);
+	// True if last check stopped because of time budget.
+	bool isBudgetExceeded() const { return budget_exceeded; }
+private:
+	std::shared_ptr<const LevelMap> map;
+	std::vector<char> boxes;
+	// Position that boxes were synced with.
+	int player, pushes;
+	// Boxes that are already assumed to be frozen are treated as walls, so the check does not loop.
+	std::vector<char> as_wall;
+	std::vector<int> walled;
+	std::vector<int> frozen;
+	long long deadline;
+	bool budget_exceeded;
+
+	void syncBoxes(const Sokoban & sokoban);
+	bool isFrozen(int cell);
+	bool isBlocked(int cell, int direction);
+};
@@ -0,0 +1,193 @@
+#include "generator.h"
+#include "levelmap.h"
+#include "solver.h"
+#include "sokoban.h"
+#include <algorithm>
+#include <random>
+#include <cmath>
+
+namespace {
+
+// Part of inner cells that become walls before connectivity is restored.
+const int WALL_PERCENT = 20;
+
+bool isInner(int x, int y, int width, int height)
+{
+	return 0 < x && x < width - 1 && 0 < y && y < height - 1;
+}
+
+// Rectangle of walls with random inner walls, only the largest connected area is kept as floor.
+std::vector<std::string> makeRoom(int width, int height, std::mt19937 & random)
+{
+	std::vector<std::string> rows(height, std::string(width, '#'));
+	for(int y = 1; y < height - 1; ++y) {
+		for(int x = 1; x < width - 1; ++x) {
+			rows[y][x] = (int(random() % 100) < WALL_PERCENT) ? '#' : ' ';
+		}
+	}
+	std::vector<int> area(width * height, -1);
+	int best_area = -1, best_size = 0;
+	for(int start = 0, area_count = 0; start < width * height; ++start) {
+		if(rows[start / width][start % width] != ' ' || area[start] >= 0) {
+			continue;
+		}
+		std::vector<int> queue(1, start);
+		area[start] = area_count;
+		for(unsigned i = 0; i < queue.size(); ++i) {
+			int x = queue[i] % width, y = queue[i] / width;
+			const int next[] = { queue[i] - 1, queue[i] + 1, queue[i] - width, queue[i] + width };
+			const bool valid[] = { x > 0, x < width - 1, y > 0, y < height - 1 };
+			for(int j = 0; j < 4; ++j) {
+				if(valid[j] && rows[next[j] / width][next[j] % width] == ' ' && area[next[j]] < 0) {
+					area[next[j]] = area_count;
+					queue.push_back(next[j]);
+				}
+			}
+		}
+		if(int(queue.size()) > best_size) {
+			best_size = queue.size();
+			best_area = area_count;
+		}
+		++area_count;
+	}
+	for(int i = 0; i < width * height; ++i) {
+		if(isInner(i % width, i / width, width, height) && area[i] != best_area) {
+			rows[i / width][i % width] = '#';
+		}
+	}
+	return rows;
+}
+
+std::string toField(const std::vector<std::string> & rows)
+{
+	std::string result;
+	for(unsigned y = 0; y < rows.size(); ++y) {
+		result += rows[y] + ((y + 1 < rows.size()) ? "\n" : "");
+	}
+	return result;
+}
+
+// Plays random pulls from solved position. Returns sum of goal distances of boxes, which is used to pick the farthest play.
+int reversePlay(const LevelMap & map, int pull_count, std::vector<char> & boxes, int & player, std::mt19937 & random)
+{
+	std::vector<int> reachable;
+	std::vector<char> visited(map.getCellCount());
+	std::vector<std::pair<int, int> > pulls;
+	for(int i = 0; i < pull_count; ++i) {
+		std::fill(visited.begin(), visited.end(), 0);
+		reachable.assign(1, player);
+		visited[player] = 1;
+		for(unsigned j = 0; j < reachable.size(); ++j) {
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int next = map.getNeighbour(reachable[j], direction);
+				if(next != LevelMap::NO_CELL && !boxes[next] && !visited[next]) {
+					visited[next] = 1;
+					reachable.push_back(next);
+				}
+			}
+		}
+		// Player stands next to the box and steps back, dragging box after him.
+		pulls.clear();
+		for(int cell : reachable) {
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int box = map.getNeighbour(cell, LevelMap::opposite(direction));
+				int back = map.getNeighbour(cell, direction);
+				if(box != LevelMap::NO_CELL && boxes[box] && back != LevelMap::NO_CELL && !boxes[back]) {
+					pulls.push_back(std::make_pair(box, direction));
+				}
+			}
+		}
+		if(pulls.empty()) {
+			break;
+		}
+		std::pair<int, int> pull = pulls[random() % pulls.size()];
+		int box_target = map.getNeighbour(pull.first, pull.second);
+		boxes[pull.first] = 0;
+		boxes[box_target] = 1;
+		player = map.getNeighbour(box_target, pull.second);
+	}
+	int distance = 0;
+	for(int cell = 0; cell < map.getCellCount(); ++cell) {
+		if(boxes[cell]) {
+			distance += std::max(0, map.getGoalDistance(cell));
+		}
+	}
+	return distance;
+}
+
+}
+
+Generator::Options::Options()
+	: width(10), height(8), box_count(3), min_pushes(10), pull_count(200), play_count(8), solve_nodes(200000)
+{
+}
+
+bool Generator::generate(const Options & options, unsigned seed, Level & level)
+{
+	std::mt19937 random(seed);
+	std::vector<std::string> rows = makeRoom(options.width, options.height, random);
+	std::vector<int> floor;
+	for(int y = 0; y < options.height; ++y) {
+		for(int x = 0; x < options.width; ++x) {
+			if(rows[y][x] == ' ') {
+				floor.push_back(y * options.width + x);
+			}
+		}
+	}
+	if(int(floor.size()) < options.box_count * 2 + 1) {
+		return false;
+	}
+	std::shuffle(floor.begin(), floor.end(), random);
+	for(int i = 0; i < options.box_count; ++i) {
+		rows[floor[i] / options.width][floor[i] % options.width] = '*';
+	}
+	int player_cell = floor[options.box_count];
+	rows[player_cell / options.width][player_cell % options.width] = '@';
+
+	Sokoban solved(toField(rows));
+	LevelMap map(solved);
+	std::vector<char> best_boxes;
+	int best_player = -1, best_distance = -1;
+	for(int play = 0; play < options.play_count; ++play) {
+		std::vector<char> boxes(map.getCellCount(), 0);
+		for(int box : map.getBoxIndices(solved)) {
+			boxes[box] = 1;
+		}
+		int player = map.getPlayerIndex(solved);
+		int distance = reversePlay(map, options.pull_count, boxes, player, random);
+		if(distance > best_distance) {
+			best_distance = distance;
+			best_boxes = boxes;
+			best_player = player;
+		}
+	}
+	if(best_distance <= 0) {
+		return false;
+	}
+
+	for(int cell = 0; cell < map.getCellCount(); ++cell) {
+		const Chthon::Point & pos = map.getCellPos(cell);
+		bool goal = map.isGoal(cell);
+		char ch = goal ? '.' : ' ';
+		if(best_boxes[cell]) {
+			ch = goal ? '*' : '$';
+		} else if(cell == best_player) {
+			ch = goal ? '+' : '@';
+		}
+		rows[pos.y][pos.x] = ch;
+	}
+
+	Sokoban sokoban(toField(rows));
+	Solver::Limits limits;
+	limits.nodes = options.solve_nodes;
+	Solver::Result result = Solver(sokoban).solve(limits);
+	if(result.status != Solver::SOLVED || result.pushes < options.min_pushes) {
+		return false;
+	}
+	level.field = sokoban.toString();
+	level.moves = result.moves;
+	level.pushes = result.pushes;
+	level.nodes = result.nodes;
+	level.difficulty = result.pushes + 10 * log10(double(std::max(1u, result.nodes)));
+	return true;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+
+// Random level generator.
+// Room is carved out of a rectangle, goals are placed in it and boxes are pulled away from goals
+// by random reverse moves, so resulting start position is always solvable in principle.
+// Every candidate is then checked by Solver, which also gives its difficulty.
+class Generator {
+public:
+	struct Options {
+		// Size includes outer walls.
+		int width, height;
+		int box_count;
+		// Candidates whose solution is shorter than that are rejected.
+		int min_pushes;
+		// Number of random pulls in one reverse play, several plays are made and the farthest one is kept.
+		int pull_count, play_count;
+		// Limit for solvability check of one candidate, in search nodes so that result does not depend on machine load.
+		unsigned solve_nodes;
+		Options();
+	};
+
+	struct Level {
+		std::string field;
+		int moves, pushes;
+		unsigned nodes;
+		// Solution length in pushes plus 10 for every order of magnitude of search nodes.
+		double difficulty;
+		Level() : moves(0), pushes(0), nodes(0), difficulty(0) {}
+	};
+
+	// Makes one attempt, the same seed gives the same result.
+	// Returns false if candidate is not solved within limits or is too easy.
+	static bool generate(const Options & options, unsigned seed, Level & level);
+};
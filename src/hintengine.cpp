@@ -0,0 +1,244 @@
+#include "hintengine.h"
+#include "solver.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Search that hits limits gives UNKNOWN, so huge levels do not load a core forever.
+const double SEARCH_SECONDS = 60;
+const size_t SEARCH_MEMORY_BYTES = 256 * 1024 * 1024;
+
+int getPushDirection(char step)
+{
+	switch(step) {
+		case 'L': return Sokoban::LEFT;
+		case 'R': return Sokoban::RIGHT;
+		case 'D': return Sokoban::DOWN;
+		case 'U': return Sokoban::UP;
+	}
+	return -1;
+}
+
+int getMoveDirection(char step)
+{
+	switch(step) {
+		case 'l': return Sokoban::LEFT;
+		case 'r': return Sokoban::RIGHT;
+		case 'd': return Sokoban::DOWN;
+		case 'u': return Sokoban::UP;
+	}
+	return getPushDirection(step);
+}
+
+}
+
+HintEngine::HintEngine()
+	: map(new LevelMap()), mark_stamp(0), cancel(false), stopping(false), generation(0),
+	posted(false), posted_player(LevelMap::NO_CELL),
+	search_player(LevelMap::NO_CELL), search_status(NONE), status(NONE), path_step(0)
+{
+	worker = std::thread(&HintEngine::run, this);
+}
+
+HintEngine::~HintEngine()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+		cancel = true;
+	}
+	changed.notify_all();
+	worker.join();
+}
+
+void HintEngine::setLevel(const Sokoban & sokoban)
+{
+	setLevel(sokoban, std::make_shared<LevelMap>(sokoban));
+}
+
+void HintEngine::setLevel(const Sokoban & sokoban, const std::shared_ptr<const LevelMap> & level_map)
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		map = level_map;
+		occupied.assign(map->getCellCount(), 0);
+		marks.assign(map->getCellCount(), 0);
+		mark_stamp = 0;
+		path.clear();
+		path_step = 0;
+		search_boxes.clear();
+		search_status = NONE;
+		status = NONE;
+		++generation;
+		cancel = true;
+	}
+	setPosition(sokoban);
+}
+
+void HintEngine::setPosition(const Sokoban & sokoban)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if(sokoban.isSolved()) {
+		posted = false;
+		status = NONE;
+		++generation;
+		cancel = true;
+		return;
+	}
+	posted_boxes = map->getBoxIndices(sokoban);
+	posted_player = map->getPlayerIndex(sokoban);
+	posted = true;
+	status = SEARCHING;
+	// Search for other boxes is useless, but search for the same boxes may be the one for this position.
+	if(search_status == SEARCHING && posted_boxes != search_boxes) {
+		++generation;
+		cancel = true;
+	}
+	changed.notify_all();
+}
+
+HintEngine::Hint HintEngine::getHint() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	Hint hint;
+	hint.status = status;
+	if(status == PUSH) {
+		hint.box = map->getCellPos(path[path_step].box);
+		hint.direction = path[path_step].direction;
+	}
+	return hint;
+}
+
+bool HintEngine::waitForHint(int msec) const
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	return changed.wait_for(lock, std::chrono::milliseconds(msec), [this]() { return status != SEARCHING; });
+}
+
+// Marks player's area with a new stamp and returns its smallest cell, so positions that differ only by walking are equal.
+int HintEngine::markArea(const std::vector<int> & boxes, int player)
+{
+	for(int box : boxes) {
+		occupied[box] = 1;
+	}
+	++mark_stamp;
+	area_queue.assign(1, player);
+	marks[player] = mark_stamp;
+	int result = player;
+	for(unsigned i = 0; i < area_queue.size(); ++i) {
+		result = std::min(result, area_queue[i]);
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			int next = map->getNeighbour(area_queue[i], direction);
+			if(next != LevelMap::NO_CELL && !occupied[next] && marks[next] != mark_stamp) {
+				marks[next] = mark_stamp;
+				area_queue.push_back(next);
+			}
+		}
+	}
+	for(int box : boxes) {
+		occupied[box] = 0;
+	}
+	return result;
+}
+
+// Position is on the path when boxes are the same as at some step and player can reach the cell behind the box to push.
+bool HintEngine::isOnPath(const std::vector<int> & boxes, int player)
+{
+	bool marked = false;
+	for(unsigned step = 0; step < path.size(); ++step) {
+		if(path[step].boxes != boxes) {
+			continue;
+		}
+		if(!marked) {
+			markArea(boxes, player);
+			marked = true;
+		}
+		int behind = map->getNeighbour(path[step].box, LevelMap::opposite(path[step].direction));
+		if(marks[behind] == mark_stamp) {
+			path_step = step;
+			return true;
+		}
+	}
+	return false;
+}
+
+void HintEngine::run()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	for(;;) {
+		// Only the latest position is looked at, older ones are overwritten.
+		changed.wait(lock, [this]() { return stopping || posted; });
+		if(stopping) {
+			return;
+		}
+		posted = false;
+		std::vector<int> boxes = posted_boxes;
+		int player = posted_player;
+		if(isOnPath(boxes, player)) {
+			status = PUSH;
+			changed.notify_all();
+			continue;
+		}
+		int area = markArea(boxes, player);
+		// Player only walked around, so this position was already searched.
+		if(boxes == search_boxes && area == search_player && (search_status == LOST || search_status == UNKNOWN)) {
+			status = search_status;
+			changed.notify_all();
+			continue;
+		}
+		path.clear();
+		path_step = 0;
+		search_boxes = boxes;
+		search_player = area;
+		search_status = SEARCHING;
+		unsigned search_generation = generation;
+		std::shared_ptr<const LevelMap> search_map = map;
+		cancel = false;
+		lock.unlock();
+
+		// Rooms are found here rather than in setLevel(), which is called on the render thread.
+		LevelMap solver_map = *search_map;
+		solver_map.findGoalRooms(player, boxes);
+		Solver solver(solver_map, boxes, player, solver_map.getGoals());
+		Solver::Limits limits;
+		limits.seconds = SEARCH_SECONDS;
+		limits.memory_bytes = SEARCH_MEMORY_BYTES;
+		Solver::Result result = solver.solve(limits, &cancel);
+		std::vector<PathStep> new_path;
+		if(result.status == Solver::SOLVED) {
+			for(char step : result.solution) {
+				int next = search_map->getNeighbour(player, getMoveDirection(step));
+				int direction = getPushDirection(step);
+				if(direction >= 0) {
+					PathStep push = { boxes, next, direction };
+					new_path.push_back(push);
+					*std::find(boxes.begin(), boxes.end(), next) = search_map->getNeighbour(next, direction);
+					std::sort(boxes.begin(), boxes.end());
+				}
+				player = next;
+			}
+		}
+
+		lock.lock();
+		if(search_generation != generation) {
+			// Cancelled, so the same position will be searched again.
+			search_status = NONE;
+			continue;
+		}
+		switch(result.status) {
+			case Solver::SOLVED:
+				path.swap(new_path);
+				path_step = 0;
+				search_status = path.empty() ? NONE : PUSH;
+				break;
+			case Solver::UNSOLVABLE: search_status = LOST; break;
+			default: search_status = UNKNOWN; break;
+		}
+		// Newer position is looked at in the next turn and sets status itself.
+		if(!posted) {
+			status = search_status;
+		}
+		changed.notify_all();
+	}
+}
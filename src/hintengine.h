@@ -0,0 +1,80 @@
+#pragma once
+#include "levelmap.h"
+#include "sokoban.h"
+#include <chthon2/point.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Solver on a worker thread that keeps the next push for the current position of the game ready.
+// Game reports every position change, which only posts boxes and player for the worker.
+// Worker checks whether the new position is on the known solution path, then next push is taken from the path without new search.
+// Position with other boxes cancels the running search, off-path position starts a new one.
+// Until worker looks at the posted position hint is SEARCHING.
+// Nothing here waits for the worker except waitForHint() and destructor.
+class HintEngine {
+public:
+	enum Status { NONE, SEARCHING, PUSH, LOST, UNKNOWN };
+
+	struct Hint {
+		Status status;
+		// Box to push and direction (Sokoban::LEFT..UP), only for PUSH.
+		Chthon::Point box;
+		int direction;
+		Hint() : status(NONE), direction(-1) {}
+	};
+
+	HintEngine();
+	~HintEngine();
+
+	void setLevel(const Sokoban & sokoban);
+	// The same with map that was already built for the level, e.g. by LevelSet.
+	void setLevel(const Sokoban & sokoban, const std::shared_ptr<const LevelMap> & level_map);
+	void setPosition(const Sokoban & sokoban);
+	Hint getHint() const;
+	// For tools and tests, game only polls getHint().
+	bool waitForHint(int msec) const;
+private:
+	struct PathStep {
+		std::vector<int> boxes;
+		// Push from this state: cell of the box and direction.
+		int box, direction;
+	};
+
+	// Shared with running search, so new level does not wait for it.
+	std::shared_ptr<const LevelMap> map;
+	// Buffers of the worker for player's area, cells are marked with the current stamp.
+	std::vector<char> occupied;
+	std::vector<unsigned> marks;
+	unsigned mark_stamp;
+	std::vector<int> area_queue;
+
+	mutable std::mutex mutex;
+	mutable std::condition_variable changed;
+	std::thread worker;
+	std::atomic<bool> cancel;
+	bool stopping;
+	// Every change of position that invalidates running search increases generation,
+	// results of older searches are dropped.
+	unsigned generation;
+	// The last position from setPosition() that worker has not looked at yet.
+	bool posted;
+	std::vector<int> posted_boxes;
+	int posted_player;
+	// Boxes and normalized player of the position that is (or was) searched, with its result.
+	std::vector<int> search_boxes;
+	int search_player;
+	Status search_status;
+	Status status;
+	std::vector<PathStep> path;
+	unsigned path_step;
+
+	HintEngine(const HintEngine &) = delete;
+	HintEngine & operator=(const HintEngine &) = delete;
+	int markArea(const std::vector<int> & boxes, int player);
+	bool isOnPath(const std::vector<int> & boxes, int player);
+	void run();
+};
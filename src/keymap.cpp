@@ -0,0 +1,179 @@
+#include "keymap.h"
+#include "playingmode.h"
+#include <chthon2/util.h>
+#include <chthon2/log.h>
+#include <chthon2/format.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+
+namespace {
+
+// ASCII keys go first, then keys that are defined by their scancode.
+const int ASCII_KEY_COUNT = 128;
+const int KEY_COUNT = ASCII_KEY_COUNT + SDL_NUM_SCANCODES;
+
+const char * DEFAULT_KEYMAP =
+	"Left left\n"
+	"H left\n"
+	"Down down\n"
+	"J down\n"
+	"Up up\n"
+	"K up\n"
+	"Right right\n"
+	"L right\n"
+	"Y up_left\n"
+	"U up_right\n"
+	"B down_left\n"
+	"N down_right\n"
+	"Shift-Left run_left\n"
+	"Shift-H run_left\n"
+	"Shift-Down run_down\n"
+	"Shift-J run_down\n"
+	"Shift-Up run_up\n"
+	"Shift-K run_up\n"
+	"Shift-Right run_right\n"
+	"Shift-L run_right\n"
+	"X target\n"
+	". goto\n"
+	"Space skip\n"
+	"Ctrl-Z undo\n"
+	"Backspace undo\n"
+	"Ctrl-R home\n"
+	"Home home\n"
+	"Ctrl-Q quit\n"
+	"Q quit\n"
+	"Esc escape\n"
+	"F1 hint\n"
+	"F3 toggle_overlay\n"
+	"Ctrl-0 cheat_restart\n"
+	"Ctrl-1 cheat_skip_level\n"
+	;
+
+std::map<std::string, int> generateNameToControlMap()
+{
+	std::map<std::string, int> result;
+	result["none"]             = Game::CONTROL_NONE;
+	result["skip"]             = Game::CONTROL_SKIP;
+	result["left"]             = Game::CONTROL_LEFT;
+	result["right"]            = Game::CONTROL_RIGHT;
+	result["up"]               = Game::CONTROL_UP;
+	result["down"]             = Game::CONTROL_DOWN;
+	result["up_left"]          = Game::CONTROL_UP_LEFT;
+	result["up_right"]         = Game::CONTROL_UP_RIGHT;
+	result["down_left"]        = Game::CONTROL_DOWN_LEFT;
+	result["down_right"]       = Game::CONTROL_DOWN_RIGHT;
+	result["run_left"]         = Game::CONTROL_RUN_LEFT;
+	result["run_right"]        = Game::CONTROL_RUN_RIGHT;
+	result["run_up"]           = Game::CONTROL_RUN_UP;
+	result["run_down"]         = Game::CONTROL_RUN_DOWN;
+	result["target"]           = Game::CONTROL_TARGET;
+	result["goto"]             = Game::CONTROL_GOTO;
+	result["undo"]             = Game::CONTROL_UNDO;
+	result["home"]             = Game::CONTROL_HOME;
+	result["quit"]             = Game::CONTROL_QUIT;
+	result["escape"]           = Game::CONTROL_ESCAPE;
+	result["toggle_overlay"]   = Game::CONTROL_TOGGLE_OVERLAY;
+	result["hint"]             = Game::CONTROL_HINT;
+	result["cheat_restart"]    = Game::CONTROL_CHEAT_RESTART;
+	result["cheat_skip_level"] = Game::CONTROL_CHEAT_SKIP_LEVEL;
+	return result;
+}
+
+}
+
+Keymap::Keymap()
+	: table(KEY_COUNT * MOD_COUNT, Game::CONTROL_NONE)
+{
+}
+
+int Keymap::keyIndex(SDL_Keycode key)
+{
+	if(key & SDLK_SCANCODE_MASK) {
+		int scancode = key & ~SDLK_SCANCODE_MASK;
+		return (scancode < SDL_NUM_SCANCODES) ? ASCII_KEY_COUNT + scancode : -1;
+	}
+	return (0 <= key && key < ASCII_KEY_COUNT) ? key : -1;
+}
+
+int Keymap::modifierIndex(Uint16 modifiers)
+{
+	int result = MOD_NONE;
+	if(modifiers & KMOD_SHIFT) {
+		result |= MOD_SHIFT;
+	}
+	if(modifiers & KMOD_CTRL) {
+		result |= MOD_CTRL;
+	}
+	return result;
+}
+
+int Keymap::getControl(SDL_Keycode key, Uint16 modifiers) const
+{
+	int index = keyIndex(key);
+	if(index < 0) {
+		return Game::CONTROL_NONE;
+	}
+	return table[index * MOD_COUNT + modifierIndex(modifiers)];
+}
+
+void Keymap::bind(SDL_Keycode key, int modifiers, int control)
+{
+	int index = keyIndex(key);
+	if(index >= 0) {
+		table[index * MOD_COUNT + modifierIndex(modifiers)] = control;
+	}
+}
+
+void Keymap::loadDefaults()
+{
+	loadFromString(DEFAULT_KEYMAP);
+}
+
+bool Keymap::loadFromFile(const std::string & file_name)
+{
+	std::ifstream file(file_name.c_str(), std::ifstream::in);
+	if(!file) {
+		return false;
+	}
+	std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return loadFromString(content);
+}
+
+bool Keymap::loadFromString(const std::string & content)
+{
+	static const std::map<std::string, int> nameToControl = generateNameToControlMap();
+	bool ok = true;
+	std::istringstream in(content);
+	std::string line;
+	while(std::getline(in, line)) {
+		std::istringstream words(line);
+		std::string key_name, control_name;
+		if(!(words >> key_name) || key_name[0] == '#') {
+			continue;
+		}
+		words >> control_name;
+
+		int modifiers = KMOD_NONE;
+		for(;;) {
+			if(key_name.size() > 6 && Chthon::starts_with(key_name, "Shift-")) {
+				modifiers |= KMOD_LSHIFT;
+				key_name.erase(0, 6);
+			} else if(key_name.size() > 5 && Chthon::starts_with(key_name, "Ctrl-")) {
+				modifiers |= KMOD_LCTRL;
+				key_name.erase(0, 5);
+			} else {
+				break;
+			}
+		}
+		SDL_Keycode key = SDL_GetKeyFromName(key_name == "Esc" ? "Escape" : key_name.c_str());
+		std::map<std::string, int>::const_iterator control = nameToControl.find(control_name);
+		if(key == SDLK_UNKNOWN || control == nameToControl.end()) {
+			Chthon::log(Chthon::format("Invalid key binding: '{0}'", line));
+			ok = false;
+			continue;
+		}
+		bind(key, modifiers, control->second);
+	}
+	return ok;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <SDL2/SDL.h>
+#include <string>
+#include <vector>
+
+// Key bindings compiled into flat table indexed by key code and modifier state,
+// so dispatching key event needs no allocations or lookups by name.
+// Bindings are text lines "<key> <control>", e.g. "Ctrl-Z undo" or "Shift-Left run_left".
+class Keymap {
+public:
+	Keymap();
+
+	void loadDefaults();
+	bool loadFromFile(const std::string & file_name);
+	bool loadFromString(const std::string & content);
+
+	int getControl(SDL_Keycode key, Uint16 modifiers) const;
+	void bind(SDL_Keycode key, int modifiers, int control);
+private:
+	enum { MOD_NONE = 0, MOD_SHIFT = 1, MOD_CTRL = 2, MOD_COUNT = 4 };
+	std::vector<int> table;
+
+	static int keyIndex(SDL_Keycode key);
+	static int modifierIndex(Uint16 modifiers);
+};
@@ -0,0 +1,405 @@
+#include "levelmap.h"
+#include "sokoban.h"
+#include <algorithm>
+
+namespace {
+
+const Chthon::Point SHIFTS[] = {
+	Chthon::Point(-1, 0), // LEFT
+	Chthon::Point(1, 0), // RIGHT
+	Chthon::Point(0, 1), // DOWN
+	Chthon::Point(0, -1), // UP
+};
+const char MOVE_CHARS[] = "lrdu";
+
+}
+
+LevelMap::LevelMap()
+	: map_width(0), map_height(0)
+{
+}
+
+LevelMap::LevelMap(const Sokoban & sokoban)
+	: map_width(sokoban.width()), map_height(sokoban.height()),
+	indices(map_width * map_height, NO_CELL)
+{
+	for(int y = 0; y < map_height; ++y) {
+		for(int x = 0; x < map_width; ++x) {
+			const Cell & cell = sokoban.getCellAt(x, y);
+			if(cell.type == Cell::WALL) {
+				continue;
+			}
+			indices[y * map_width + x] = positions.size();
+			positions.push_back(Chthon::Point(x, y));
+			goal_flags.push_back(cell.type == Cell::SLOT);
+			if(cell.type == Cell::SLOT) {
+				goals.push_back(positions.size() - 1);
+			}
+		}
+	}
+	neighbours.resize(positions.size() * 4, NO_CELL);
+	for(unsigned i = 0; i < positions.size(); ++i) {
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			neighbours[i * 4 + direction] = getCellIndex(positions[i] + SHIFTS[direction]);
+		}
+	}
+	tunnel_flags.resize(positions.size(), 0);
+	for(unsigned i = 0; i < positions.size(); ++i) {
+		if(getNeighbour(i, Sokoban::DOWN) == NO_CELL && getNeighbour(i, Sokoban::UP) == NO_CELL) {
+			tunnel_flags[i] |= 1;
+		}
+		if(getNeighbour(i, Sokoban::LEFT) == NO_CELL && getNeighbour(i, Sokoban::RIGHT) == NO_CELL) {
+			tunnel_flags[i] |= 2;
+		}
+	}
+	goal_distances = calculateGoalDistances(goals);
+	room_indices.assign(positions.size(), -1);
+	articulation_flags.assign(positions.size(), false);
+	int player = getPlayerIndex(sokoban);
+	if(player != NO_CELL) {
+		std::vector<int> order, by_order;
+		std::vector<Cut> cuts;
+		findCuts(player, order, by_order, cuts);
+		for(const Cut & cut : cuts) {
+			articulation_flags[cut.entrance] = true;
+		}
+	}
+}
+
+int LevelMap::getCellIndex(const Chthon::Point & pos) const
+{
+	if(pos.x < 0 || pos.y < 0 || pos.x >= map_width || pos.y >= map_height) {
+		return NO_CELL;
+	}
+	return indices[pos.y * map_width + pos.x];
+}
+
+std::vector<int> LevelMap::calculateGoalDistances(const std::vector<int> & target_goals) const
+{
+	// Boxes are pulled back from goals: box comes to a cell from the neighbour
+	// on the opposite side, and only if player could stand behind it.
+	std::vector<int> distances(positions.size(), -1);
+	std::vector<int> queue = target_goals;
+	for(int goal : target_goals) {
+		distances[goal] = 0;
+	}
+	for(unsigned i = 0; i < queue.size(); ++i) {
+		int cell = queue[i];
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			int from = getNeighbour(cell, opposite(direction));
+			if(from == NO_CELL || distances[from] >= 0) {
+				continue;
+			}
+			if(getNeighbour(from, opposite(direction)) == NO_CELL) {
+				continue;
+			}
+			distances[from] = distances[cell] + 1;
+			queue.push_back(from);
+		}
+	}
+	return distances;
+}
+
+int LevelMap::getPlayerIndex(const Sokoban & sokoban) const
+{
+	return getCellIndex(sokoban.getPlayerPos());
+}
+
+std::vector<int> LevelMap::getBoxIndices(const Sokoban & sokoban) const
+{
+	std::vector<int> result;
+	for(const Object & box : sokoban.getBoxes()) {
+		result.push_back(getCellIndex(box.pos));
+	}
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+bool LevelMap::findPath(const std::vector<char> & occupied, int from, int to, std::string & path) const
+{
+	path.clear();
+	std::vector<int> came_from(positions.size(), -1);
+	std::vector<int> queue(1, from);
+	came_from[from] = from;
+	for(unsigned i = 0; i < queue.size() && came_from[to] < 0; ++i) {
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			int next = getNeighbour(queue[i], direction);
+			if(next != NO_CELL && !occupied[next] && came_from[next] < 0) {
+				came_from[next] = queue[i];
+				queue.push_back(next);
+			}
+		}
+	}
+	if(came_from[to] < 0) {
+		return false;
+	}
+	for(int cell = to; cell != from; cell = came_from[cell]) {
+		int prev = came_from[cell];
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			if(getNeighbour(prev, direction) == cell) {
+				path += MOVE_CHARS[direction];
+				break;
+			}
+		}
+	}
+	std::reverse(path.begin(), path.end());
+	return true;
+}
+
+int LevelMap::pushBox(const std::vector<char> & occupied, int player, int box, int target, int & final_player, std::string * path) const
+{
+	// State is a box cell and direction of the last push, player stands right behind the box.
+	enum { START = -2 };
+	std::vector<int> came_from(positions.size() * 4, NO_CELL);
+	std::vector<int> queue;
+	std::vector<char> blocked = occupied;
+	std::vector<int> reachable;
+	std::vector<char> visited(positions.size(), 0);
+	int found = NO_CELL;
+	auto expand = [&](int state, int from_box, int from_player) {
+		blocked[from_box] = 1;
+		std::fill(visited.begin(), visited.end(), 0);
+		reachable.assign(1, from_player);
+		visited[from_player] = 1;
+		for(unsigned i = 0; i < reachable.size(); ++i) {
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int next = getNeighbour(reachable[i], direction);
+				if(next != NO_CELL && !blocked[next] && !visited[next]) {
+					visited[next] = 1;
+					reachable.push_back(next);
+				}
+			}
+		}
+		blocked[from_box] = 0;
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			int behind = getNeighbour(from_box, opposite(direction));
+			int next = getNeighbour(from_box, direction);
+			if(behind == NO_CELL || next == NO_CELL || !visited[behind] || blocked[next]) {
+				continue;
+			}
+			int next_state = next * 4 + direction;
+			if(came_from[next_state] == NO_CELL) {
+				came_from[next_state] = state;
+				queue.push_back(next_state);
+			}
+		}
+	};
+	if(box == target) {
+		final_player = player;
+		if(path) {
+			path->clear();
+		}
+		return 0;
+	}
+	expand(START, box, player);
+	for(unsigned i = 0; i < queue.size() && found == NO_CELL; ++i) {
+		int state = queue[i];
+		if(state / 4 == target) {
+			found = state;
+			break;
+		}
+		expand(state, state / 4, getNeighbour(state / 4, opposite(state % 4)));
+	}
+	if(found == NO_CELL) {
+		return -1;
+	}
+	std::vector<int> pushes;
+	for(int state = found; state != START; state = came_from[state]) {
+		pushes.push_back(state);
+	}
+	std::reverse(pushes.begin(), pushes.end());
+	final_player = getNeighbour(target, opposite(found % 4));
+	if(path) {
+		static const char PUSH_CHARS[] = "LRDU";
+		path->clear();
+		std::string walk;
+		int current_box = box, current_player = player;
+		for(int state : pushes) {
+			int direction = state % 4;
+			blocked[current_box] = 1;
+			findPath(blocked, current_player, getNeighbour(current_box, opposite(direction)), walk);
+			blocked[current_box] = 0;
+			*path += walk;
+			*path += PUSH_CHARS[direction];
+			current_player = current_box;
+			current_box = state / 4;
+		}
+	}
+	return pushes.size();
+}
+
+// Cells that are not reachable from the player keep order -1.
+void LevelMap::findCuts(int player, std::vector<int> & order, std::vector<int> & by_order, std::vector<Cut> & cuts) const
+{
+	int cell_count = positions.size();
+	order.assign(cell_count, -1);
+	by_order.clear();
+	cuts.clear();
+	std::vector<int> low(cell_count, 0), subtree_size(cell_count, 1), parent(cell_count, NO_CELL);
+	// Iterative DFS, next direction to try is kept for every cell on the stack.
+	std::vector<std::pair<int, int> > stack(1, std::make_pair(player, 0));
+	order[player] = low[player] = 0;
+	by_order.push_back(player);
+	std::vector<Cut> root_cuts;
+	while(!stack.empty()) {
+		int cell = stack.back().first;
+		int & direction = stack.back().second;
+		if(direction < 4) {
+			int next = getNeighbour(cell, direction++);
+			if(next == NO_CELL) {
+				continue;
+			}
+			if(order[next] < 0) {
+				order[next] = low[next] = by_order.size();
+				by_order.push_back(next);
+				parent[next] = cell;
+				stack.push_back(std::make_pair(next, 0));
+			} else if(next != parent[cell]) {
+				low[cell] = std::min(low[cell], order[next]);
+			}
+			continue;
+		}
+		stack.pop_back();
+		int up = parent[cell];
+		if(up != NO_CELL) {
+			low[up] = std::min(low[up], low[cell]);
+			subtree_size[up] += subtree_size[cell];
+			if(low[cell] >= order[up]) {
+				Cut cut = { up, order[cell], subtree_size[cell] };
+				(up == player ? root_cuts : cuts).push_back(cut);
+			}
+		}
+	}
+	// Player's cell cuts the level only if search went from it in several directions.
+	if(root_cuts.size() > 1) {
+		cuts.insert(cuts.end(), root_cuts.begin(), root_cuts.end());
+	}
+}
+
+// Rooms are subtrees of depth-first search from the player that are cut off by a single cell (articulation point).
+// For every group of adjacent goals the smallest such subtree that contains the whole group is taken.
+void LevelMap::findGoalRooms(int player, const std::vector<int> & boxes)
+{
+	goal_rooms.clear();
+	room_indices.assign(positions.size(), -1);
+	if(player == NO_CELL) {
+		return;
+	}
+	int cell_count = positions.size();
+	std::vector<int> order, by_order;
+	std::vector<Cut> cuts;
+	findCuts(player, order, by_order, cuts);
+
+	std::vector<char> has_box(cell_count, 0);
+	for(int box : boxes) {
+		has_box[box] = 1;
+	}
+	std::vector<int> group(cell_count, -1);
+	for(int goal : goals) {
+		if(group[goal] >= 0 || order[goal] < 0) {
+			continue;
+		}
+		std::vector<int> cells(1, goal);
+		group[goal] = goal;
+		int first = order[goal], last = order[goal];
+		for(unsigned i = 0; i < cells.size(); ++i) {
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int next = getNeighbour(cells[i], direction);
+				if(next != NO_CELL && goal_flags[next] && group[next] < 0) {
+					group[next] = goal;
+					cells.push_back(next);
+					first = std::min(first, order[next]);
+					last = std::max(last, order[next]);
+				}
+			}
+		}
+		const Cut * best = 0;
+		for(const Cut & cut : cuts) {
+			if(cut.first <= first && last < cut.first + cut.size && (!best || cut.size < best->size)) {
+				best = &cut;
+			}
+		}
+		if(!best) {
+			continue;
+		}
+		GoalRoom room;
+		room.entrance = best->entrance;
+		bool has_free_box = false;
+		for(int i = best->first; i < best->first + best->size; ++i) {
+			int cell = by_order[i];
+			room.cells.push_back(cell);
+			if(goal_flags[cell]) {
+				room.goals.push_back(cell);
+			} else if(has_box[cell]) {
+				has_free_box = true;
+			}
+		}
+		if(has_free_box) {
+			continue;
+		}
+		// Another goal group may have led to the same room or to the one around it, the outer one is kept.
+		bool is_inner = false;
+		for(unsigned i = 0; i < goal_rooms.size() && !is_inner; ++i) {
+			GoalRoom & other = goal_rooms[i];
+			if(std::find(other.cells.begin(), other.cells.end(), room.cells.front()) != other.cells.end()) {
+				is_inner = true;
+			} else if(std::find(room.cells.begin(), room.cells.end(), other.cells.front()) != room.cells.end()) {
+				other = room;
+				is_inner = true;
+			}
+		}
+		if(!is_inner) {
+			goal_rooms.push_back(room);
+		}
+	}
+	for(unsigned i = 0; i < goal_rooms.size(); ++i) {
+		calculatePackingOrder(goal_rooms[i]);
+		for(int cell : goal_rooms[i].cells) {
+			room_indices[cell] = i;
+		}
+	}
+}
+
+// Reverse search: with all goals filled, the goal whose box could be pushed in last is removed, and so on.
+// Removing a box only frees the way for others, so the first removable goal can always be taken.
+void LevelMap::calculatePackingOrder(GoalRoom & room) const
+{
+	room.packing_order.clear();
+	std::vector<int> outside;
+	for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+		int next = getNeighbour(room.entrance, direction);
+		if(next != NO_CELL && std::find(room.cells.begin(), room.cells.end(), next) == room.cells.end()) {
+			outside.push_back(next);
+		}
+	}
+	std::vector<char> filled(positions.size(), 0);
+	for(int goal : room.goals) {
+		filled[goal] = 1;
+	}
+	std::vector<int> remaining = room.goals;
+	while(!remaining.empty()) {
+		bool removed = false;
+		for(unsigned i = 0; i < remaining.size() && !removed; ++i) {
+			int goal = remaining[i];
+			filled[goal] = 0;
+			for(int player : outside) {
+				int final_player = NO_CELL;
+				if(pushBox(filled, player, room.entrance, goal, final_player) >= 0) {
+					removed = true;
+					break;
+				}
+			}
+			if(removed) {
+				room.packing_order.push_back(goal);
+				remaining.erase(remaining.begin() + i);
+			} else {
+				filled[goal] = 1;
+			}
+		}
+		if(!removed) {
+			room.packing_order.clear();
+			return;
+		}
+	}
+	std::reverse(room.packing_order.begin(), room.packing_order.end());
+}
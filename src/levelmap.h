@@ -0,0 +1,86 @@
+#pragma once
+#include <chthon2/point.h>
+#include <string>
+#include <vector>
+class Sokoban;
+
+// Static geometry of a level prepared for search and analysis.
+// Every non-wall cell gets an index, so positions can be kept as small integers
+// and neighbours are taken from a table instead of point arithmetic and bounds checks.
+// Directions are the same as Sokoban::LEFT..UP.
+class LevelMap {
+public:
+	enum { NO_CELL = -1 };
+
+	// Part of the level with goals that player can enter only through one cell.
+	// Boxes can be packed into it one by one in the packing order, each pushed from entrance straight to its goal.
+	struct GoalRoom {
+		std::vector<int> cells;
+		std::vector<int> goals;
+		int entrance;
+		// Empty if goals cannot be filled one by one through the entrance.
+		std::vector<int> packing_order;
+	};
+
+	LevelMap();
+	explicit LevelMap(const Sokoban & sokoban);
+
+	int width() const { return map_width; }
+	int height() const { return map_height; }
+	int getCellCount() const { return positions.size(); }
+	// Returns NO_CELL for walls and points outside of the map.
+	int getCellIndex(const Chthon::Point & pos) const;
+	const Chthon::Point & getCellPos(int index) const { return positions[index]; }
+	int getNeighbour(int index, int direction) const { return neighbours[index * 4 + direction]; }
+	static int opposite(int direction) { return direction ^ 1; }
+
+	bool isGoal(int index) const { return goal_flags[index]; }
+	const std::vector<int> & getGoals() const { return goals; }
+	// Minimal number of pushes to move a box from the cell to any goal, ignoring other boxes,
+	// or -1 when box on this cell can never be pushed to a goal.
+	int getGoalDistance(int index) const { return goal_distances[index]; }
+	bool isDead(int index) const { return goal_distances[index] < 0; }
+	// The same distances for any other set of goals, e.g. positions that search should reach.
+	std::vector<int> calculateGoalDistances(const std::vector<int> & target_goals) const;
+	// One-wide corridor along the direction: both cells to the sides are walls.
+	bool isTunnel(int index, int direction) const { return (tunnel_flags[index] & (1 << (direction / 2))) != 0; }
+	// Cell that splits the floor into parts when it is blocked, found from the player's area of the position the map was created for.
+	bool isArticulation(int index) const { return articulation_flags[index]; }
+
+	int getPlayerIndex(const Sokoban & sokoban) const;
+	// Sorted indices of cells with boxes.
+	std::vector<int> getBoxIndices(const Sokoban & sokoban) const;
+	// Shortest player walk as lowercase LURD, cells marked in occupied are obstacles.
+	// Returns false if target cannot be reached.
+	bool findPath(const std::vector<char> & occupied, int from, int to, std::string & path) const;
+	// Minimal number of pushes to move one box to target, or -1 if it is not possible.
+	// Cells marked in occupied are obstacles, the box itself should not be marked.
+	// Final player cell and, if path is given, LURD of all steps are returned too.
+	int pushBox(const std::vector<char> & occupied, int player, int box, int target, int & final_player, std::string * path = 0) const;
+
+	// Rooms take searches for packing order, so map has none until they are asked for, e.g. by Solver.
+	// Room should contain no boxes of the given position except on goals.
+	void findGoalRooms(int player, const std::vector<int> & boxes);
+	const std::vector<GoalRoom> & getGoalRooms() const { return goal_rooms; }
+	// Index of room that contains the cell, or -1.
+	int getGoalRoom(int index) const { return room_indices[index]; }
+private:
+	// Subtree of depth-first search that is cut off by a single cell (entrance), subtree cells are consecutive in visiting order.
+	struct Cut { int entrance, first, size; };
+
+	int map_width, map_height;
+	std::vector<int> indices;
+	std::vector<Chthon::Point> positions;
+	std::vector<int> neighbours;
+	std::vector<bool> goal_flags;
+	std::vector<int> goals;
+	std::vector<int> goal_distances;
+	// Bit 0 is tunnel along LEFT/RIGHT, bit 1 along DOWN/UP.
+	std::vector<char> tunnel_flags;
+	std::vector<bool> articulation_flags;
+	std::vector<GoalRoom> goal_rooms;
+	std::vector<int> room_indices;
+
+	void findCuts(int player, std::vector<int> & order, std::vector<int> & by_order, std::vector<Cut> & cuts) const;
+	void calculatePackingOrder(GoalRoom & room) const;
+};
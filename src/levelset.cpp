@@ -1,4 +1,5 @@
 #include "levelset.h"
+#include "profiler.h"
 #include <chthon2/xmlreader.h>
 #include <chthon2/util.h>
 #include <chthon2/log.h>
@@ -20,6 +21,7 @@ bool LevelSet::loadFromFile(const std::string & file_name, int startLevelIndex)
 
 bool LevelSet::loadFromString(const std::string & content, int startLevelIndex)
 {
+	PROFILE_SCOPE("LevelSet::loadFromString");
 	std::istringstream in(content);
 	Chthon::XMLReader reader(in);
 	reader.skip_to_tag("Title");
@@ -42,7 +44,7 @@ bool LevelSet::loadFromString(const std::string & content, int startLevelIndex)
 }
 
 LevelSet::LevelSet()
-	: over(true), currentLevelIndex(-1)
+	: over(true), currentLevelIndex(-1), prefetchedLevelIndex(-1)
 {
 }
 
@@ -69,6 +71,22 @@ std::string LevelSet::getCurrentLevelName() const
 	return xml_levels[currentLevelIndex].first;
 }
 
+std::string LevelSet::getLevelName(int levelIndex) const
+{
+	if(levelIndex < 0 || int(xml_levels.size()) <= levelIndex) {
+		return std::string();
+	}
+	return xml_levels[levelIndex].first;
+}
+
+Sokoban LevelSet::getSokoban(int levelIndex) const
+{
+	if(levelIndex < 0 || int(xml_levels.size()) <= levelIndex) {
+		return Sokoban();
+	}
+	return Sokoban(xml_levels[levelIndex].second);
+}
+
 std::string LevelSet::getCurrentLevelSet() const
 {
 	return file_name;
@@ -76,6 +94,7 @@ std::string LevelSet::getCurrentLevelSet() const
 
 bool LevelSet::moveToNextLevel()
 {
+	PROFILE_SCOPE("LevelSet::moveToNextLevel");
 	if(over) {
 		return false;
 	}
@@ -85,7 +104,37 @@ bool LevelSet::moveToNextLevel()
 		return false;
 	}
 	currentLevel = xml_levels[currentLevelIndex].second;
-	currentSokoban = Sokoban(currentLevel);
+	// Prefetched level is moved out of the future, so render thread only swaps ready objects.
+	PreparedLevel prepared = (prefetchedLevelIndex == currentLevelIndex && prefetchedLevel.valid())
+		? prefetchedLevel.get()
+		: prepareLevel(currentLevel);
+	currentSokoban = std::move(prepared.sokoban);
+	currentLevelMap = std::move(prepared.map);
+	prefetchLevel(currentLevelIndex + 1);
 	return true;
 }
 
+LevelSet::PreparedLevel LevelSet::prepareLevel(const std::string & level)
+{
+	PreparedLevel prepared;
+	prepared.sokoban = Sokoban(level);
+	prepared.map = std::make_shared<LevelMap>(prepared.sokoban);
+	return prepared;
+}
+
+void LevelSet::prefetchLevel(int levelIndex)
+{
+	if(levelIndex >= int(xml_levels.size())) {
+		prefetchedLevelIndex = -1;
+		prefetchedLevel = std::future<PreparedLevel>();
+		return;
+	}
+	// Level is parsed and analyzed by worker thread while current one is played.
+	std::string level = xml_levels[levelIndex].second;
+	prefetchedLevelIndex = levelIndex;
+	prefetchedLevel = std::async(std::launch::async, [level]() {
+			PROFILE_SCOPE("LevelSet::prefetch");
+			return prepareLevel(level);
+			});
+}
+
@@ -1,12 +1,18 @@
 #pragma once
 #include "sokoban.h"
+#include "levelmap.h"
 #include <vector>
 #include <string>
+#include <future>
+#include <memory>
 
 class LevelSet {
 public:
 	LevelSet();
 	virtual ~LevelSet() {}
+	// Prefetched level cannot be copied, so levelset can only be moved.
+	LevelSet(LevelSet &&) = default;
+	LevelSet & operator=(LevelSet &&) = default;
 
 	bool loadFromFile(const std::string & file_name, int startLevelIndex);
 	bool loadFromString(const std::string & content, int startLevelIndex);
@@ -20,15 +26,30 @@ public:
 	const std::string & getLevelSetTitle() const;
 	std::string getCurrentLevelSet() const;
 	const Sokoban & getCurrentSokoban() const { return currentSokoban; }
+	// Prepared together with the level, so game does not build it on level change.
+	const std::shared_ptr<const LevelMap> & getCurrentLevelMap() const { return currentLevelMap; }
+	std::string getLevelName(int levelIndex) const;
+	Sokoban getSokoban(int levelIndex) const;
 	bool isOver() const { return over; }
 private:
+	struct PreparedLevel {
+		Sokoban sokoban;
+		std::shared_ptr<const LevelMap> map;
+	};
+
 	bool over;
 	int currentLevelIndex;
 	std::string currentLevel;
 	Sokoban currentSokoban;
+	std::shared_ptr<const LevelMap> currentLevelMap;
+	int prefetchedLevelIndex;
+	std::future<PreparedLevel> prefetchedLevel;
 	std::string levelSetTitle;
 
 	std::string file_name;
 	std::vector<std::pair<std::string, std::string> > xml_levels;
+
+	void prefetchLevel(int levelIndex);
+	static PreparedLevel prepareLevel(const std::string & level);
 };
 
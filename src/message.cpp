@@ -13,7 +13,7 @@ void Message::processTime(int msec_passed)
 }
 
 Message::Message(const Sprites & _sprites, const std::string & message_text)
-	: sprites(_sprites), done(false), countdown(1000)
+	: sprites(_sprites), done(false), countdown(1000), cache(_sprites)
 {
 	set_text(message_text);
 }
@@ -22,18 +22,12 @@ void Message::set_text(const std::string & message_text)
 {
 	countdown.start();
 	done = false;
-	lines.clear();
-	lines.push_back(std::string());
-	max_width = 0;
-	for(char ch : message_text) {
-		if(ch != '\n') {
-			lines.back() += ch;
-		} else {
-			max_width = std::max(max_width, (unsigned)lines.back().size());
-			lines.push_back(std::string());
-		}
-	}
-	max_width = std::max(max_width, (unsigned)lines.back().size());
+	text = message_text;
+}
+
+void Message::invalidate()
+{
+	cache.clear();
 }
 
 bool Message::is_done() const
@@ -41,6 +35,11 @@ bool Message::is_done() const
 	return done;
 }
 
+bool Message::is_animating() const
+{
+	return !done && countdown.is_active();
+}
+
 void Message::processControl(int control)
 {
 	if(control == Game::CONTROL_SKIP) {
@@ -58,29 +57,20 @@ void center_rect(SDL_Rect & rect, const SDL_Rect & other_rect)
 
 void Message::paint(SDL_Renderer * painter, const SDL_Rect & rect)
 {
+	SDL_SetRenderDrawColor(painter, 0, 0, 0, 255);
 	SDL_RenderClear(painter);
-	SDL_Rect dest_rect;
-	dest_rect.x = 0;
-	dest_rect.y = 0;
-	dest_rect.w = sprites.getCharRect(0).w;
-	dest_rect.h = sprites.getCharRect(0).h;
-
-	SDL_Rect text_rect;
-	text_rect.x = 0;
-	text_rect.y = 0;
-	text_rect.w = dest_rect.w * max_width;
-	text_rect.h = dest_rect.h * lines.size();
-
+	SDL_Rect text_rect = TextCache::getTextRect(sprites, text, 1);
 	center_rect(text_rect, rect);
-	dest_rect.y = text_rect.y;
-	for(const std::string & line : lines) {
-		dest_rect.x = text_rect.x + (dest_rect.w * (max_width - line.size())) / 2 ;
-		for(char ch : line) {
-			SDL_Rect char_rect = sprites.getCharRect(ch);
-			SDL_RenderCopy(painter, sprites.getFont(), &char_rect, &dest_rect);
-			dest_rect.x += dest_rect.w;
-		}
-		dest_rect.y += dest_rect.h;
+
+	SDL_Texture * texture = cache.getText(painter, text, 1);
+	if(texture) {
+		SDL_Rect src_rect = text_rect;
+		src_rect.x = 0;
+		src_rect.y = 0;
+		SDL_RenderCopy(painter, texture, &src_rect, &text_rect);
+	} else {
+		batch.begin(painter);
+		TextCache::paintText(batch, sprites, text, text_rect.x, text_rect.y, 1);
+		batch.end();
 	}
 }
-
@@ -1,7 +1,7 @@
 #pragma once
 #include "counter.h"
+#include "textcache.h"
 #include <string>
-#include <vector>
 class Sprites;
 class SDL_Renderer;
 class SDL_Rect;
@@ -11,14 +11,17 @@ public:
 	Message(const Sprites & _sprites, const std::string & message_text);
 	void set_text(const std::string & message_text);
 	bool is_done() const;
+	bool is_animating() const;
 	void processControl(int control);
 	void paint(SDL_Renderer * painter, const SDL_Rect & rect);
 	void processTime(int msec_passed);
+	void invalidate();
 private:
 	const Sprites & sprites;
 	bool done;
-	std::vector<std::string> lines;
-	unsigned max_width;
+	std::string text;
 	Counter countdown;
+	TextCache cache;
+	SpriteBatch batch;
 };
 
@@ -0,0 +1,52 @@
+#include "metrics.h"
+#include "sokoban.h"
+#include <algorithm>
+
+namespace {
+
+// Breadth-first fill from start over cells accepted by the filter. Returns filled cells.
+template<class Filter>
+std::vector<int> fill(const LevelMap & map, int start, std::vector<bool> & visited, Filter filter)
+{
+	std::vector<int> queue(1, start);
+	visited[start] = true;
+	for(unsigned i = 0; i < queue.size(); ++i) {
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			int next = map.getNeighbour(queue[i], direction);
+			if(next != LevelMap::NO_CELL && !visited[next] && filter(next)) {
+				visited[next] = true;
+				queue.push_back(next);
+			}
+		}
+	}
+	return queue;
+}
+
+bool anyCell(int) { return true; }
+
+}
+
+LevelMetrics LevelMetrics::analyze(const Sokoban & sokoban, const Solver::Limits & limits)
+{
+	LevelMetrics metrics;
+	Solver solver(sokoban);
+	const LevelMap & map = solver.getLevelMap();
+	metrics.box_count = map.getBoxIndices(sokoban).size();
+
+	std::vector<bool> visited(map.getCellCount(), false);
+	std::vector<int> floor = fill(map, map.getPlayerIndex(sokoban), visited, anyCell);
+	metrics.floor_area = floor.size();
+	int dead_count = std::count_if(floor.begin(), floor.end(), [&map](int cell) { return map.isDead(cell); });
+	metrics.dead_ratio = metrics.floor_area > 0 ? double(dead_count) / metrics.floor_area : 0;
+
+	// Solver has found rooms for its goal room macros.
+	for(const LevelMap::GoalRoom & room : map.getGoalRooms()) {
+		++metrics.goal_rooms;
+		metrics.largest_goal_room = std::max(metrics.largest_goal_room, int(room.cells.size()));
+		metrics.room_goals += room.goals.size();
+		metrics.packed_goals += room.packing_order.size();
+	}
+
+	metrics.search = solver.solve(limits);
+	return metrics;
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "solver.h"
+class Sokoban;
+
+// Static and search-based properties of a level, used to order levels by difficulty
+// and to find levels which are too expensive to analyse.
+struct LevelMetrics {
+	int box_count;
+	// Cells reachable by player when boxes are ignored.
+	int floor_area;
+	// Goal rooms of the start position (see LevelMap::GoalRoom), cells of the largest one,
+	// goals inside rooms and those of them that can be filled one by one in packing order.
+	int goal_rooms;
+	int largest_goal_room;
+	int room_goals;
+	int packed_goals;
+	// Part of floor where box can never reach a goal.
+	double dead_ratio;
+	// Result of solver, pushes are close to minimal but are not guaranteed to be optimal.
+	Solver::Result search;
+	LevelMetrics() : box_count(0), floor_area(0), goal_rooms(0), largest_goal_room(0), room_goals(0), packed_goals(0), dead_ratio(0) {}
+
+	// Level is parsed once, all static metrics are taken from the solver's level map.
+	static LevelMetrics analyze(const Sokoban & sokoban, const Solver::Limits & limits);
+};
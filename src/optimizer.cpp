@@ -0,0 +1,181 @@
+#include "optimizer.h"
+#include "solver.h"
+#include "sokoban.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+const char PUSH_CHARS[] = "LRDU";
+
+int getDirection(char step)
+{
+	switch(step) {
+		case 'l': case 'L': return Sokoban::LEFT;
+		case 'r': case 'R': return Sokoban::RIGHT;
+		case 'd': case 'D': return Sokoban::DOWN;
+		case 'u': case 'U': return Sokoban::UP;
+	}
+	return -1;
+}
+
+}
+
+Optimizer::Options::Options()
+	: window(8), seconds(10), window_seconds(1)
+{
+}
+
+Optimizer::Optimizer(const Sokoban & sokoban)
+	: map(sokoban), start_boxes(map.getBoxIndices(sokoban)), start_player(map.getPlayerIndex(sokoban))
+{
+}
+
+// Replays solution on cell indices. Case of steps is not trusted, pushes are detected by boxes.
+bool Optimizer::parsePushes(const std::string & solution, std::vector<Push> & pushes) const
+{
+	std::vector<char> boxes(map.getCellCount(), 0);
+	for(int box : start_boxes) {
+		boxes[box] = 1;
+	}
+	int player = start_player;
+	pushes.clear();
+	for(char step : solution) {
+		int direction = getDirection(step);
+		if(direction < 0) {
+			return false;
+		}
+		int next = map.getNeighbour(player, direction);
+		if(next == LevelMap::NO_CELL) {
+			return false;
+		}
+		if(boxes[next]) {
+			int target = map.getNeighbour(next, direction);
+			if(target == LevelMap::NO_CELL || boxes[target]) {
+				return false;
+			}
+			boxes[next] = 0;
+			boxes[target] = 1;
+			Push push = { next, direction };
+			pushes.push_back(push);
+		}
+		player = next;
+	}
+	for(int goal : map.getGoals()) {
+		if(!boxes[goal]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Builds LURD string with the shortest walks between pushes. Returns false if pushes cannot be made in this order.
+bool Optimizer::composeSolution(const std::vector<Push> & pushes, std::string & solution) const
+{
+	std::vector<char> boxes(map.getCellCount(), 0);
+	for(int box : start_boxes) {
+		boxes[box] = 1;
+	}
+	int player = start_player;
+	solution.clear();
+	std::string walk;
+	for(const Push & push : pushes) {
+		int behind = map.getNeighbour(push.box, LevelMap::opposite(push.direction));
+		int target = map.getNeighbour(push.box, push.direction);
+		if(!boxes[push.box] || behind == LevelMap::NO_CELL || target == LevelMap::NO_CELL || boxes[target]) {
+			return false;
+		}
+		if(!map.findPath(boxes, player, behind, walk)) {
+			return false;
+		}
+		solution += walk;
+		solution += PUSH_CHARS[push.direction];
+		boxes[push.box] = 0;
+		boxes[target] = 1;
+		player = push.box;
+	}
+	return true;
+}
+
+Optimizer::Result Optimizer::optimize(const std::string & solution, const Options & options) const
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start_time = Clock::now();
+	Result result;
+	std::vector<Push> pushes;
+	if(!parsePushes(solution, pushes) || !composeSolution(pushes, result.solution)) {
+		return result;
+	}
+	result.valid = true;
+	result.moves_before = solution.size();
+	result.pushes_before = pushes.size();
+
+	int window = std::max(1, options.window);
+	int step = std::max(1, window / 2);
+	bool improved = true;
+	double seconds = 0;
+	while(improved && seconds < options.seconds) {
+		improved = false;
+		std::vector<int> boxes = start_boxes;
+		int player = start_player;
+		for(int start = 0; start < int(pushes.size()) && seconds < options.seconds; ) {
+			int end = std::min(int(pushes.size()), start + window);
+			std::vector<int> targets = boxes;
+			for(int i = start; i < end; ++i) {
+				*std::find(targets.begin(), targets.end(), pushes[i].box) = map.getNeighbour(pushes[i].box, pushes[i].direction);
+			}
+
+			Solver::Limits limits;
+			limits.seconds = std::min(options.window_seconds, options.seconds - seconds);
+			Solver::Result window_result = Solver(map, boxes, player, targets).solve(limits);
+			++result.windows;
+			if(window_result.status == Solver::TOO_LARGE) {
+				// Every other window is refused the same way.
+				result.unsolved_windows = result.windows;
+				improved = false;
+				break;
+			}
+			if(window_result.status != Solver::SOLVED) {
+				++result.unsolved_windows;
+			}
+			if(window_result.status == Solver::SOLVED && window_result.pushes <= end - start) {
+				// Window solution is a valid continuation of the same position, so it is parsed as pushes from there.
+				std::vector<Push> candidate(pushes.begin(), pushes.begin() + start);
+				int cell = player;
+				for(char ch : window_result.solution) {
+					int direction = getDirection(ch);
+					int next = map.getNeighbour(cell, direction);
+					if(ch == PUSH_CHARS[direction]) {
+						Push push = { next, direction };
+						candidate.push_back(push);
+					}
+					cell = next;
+				}
+				candidate.insert(candidate.end(), pushes.begin() + end, pushes.end());
+				std::string candidate_solution;
+				if(composeSolution(candidate, candidate_solution)) {
+					bool better = candidate.size() < pushes.size() ||
+						(candidate.size() == pushes.size() && candidate_solution.size() < result.solution.size());
+					if(better) {
+						pushes.swap(candidate);
+						result.solution.swap(candidate_solution);
+						++result.improvements;
+						improved = true;
+					}
+				}
+			}
+
+			int next_start = std::min(int(pushes.size()), start + step);
+			for(; start < next_start; ++start) {
+				*std::find(boxes.begin(), boxes.end(), pushes[start].box) = map.getNeighbour(pushes[start].box, pushes[start].direction);
+				player = pushes[start].box;
+			}
+			seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+		}
+	}
+
+	result.moves = result.solution.size();
+	result.pushes = pushes.size();
+	result.seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+	return result;
+}
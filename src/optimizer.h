@@ -0,0 +1,52 @@
+#pragma once
+#include "levelmap.h"
+#include <string>
+#include <vector>
+class Sokoban;
+
+// Improves existing solution instead of solving level from scratch.
+// Solution is reduced to a list of pushes and player walks between them are rebuilt as shortest paths.
+// Then short windows of pushes are re-solved by Solver between intermediate positions of the solution
+// (boxes of the window's end become goals), and a shorter window replaces the original one.
+// All windows are solved on the same LevelMap, only boxes, player and goals change.
+// Pushes are improved first, moves second.
+class Optimizer {
+public:
+	struct Options {
+		// Number of pushes in one window.
+		int window;
+		// Limit for the whole optimization and for solving one window.
+		double seconds, window_seconds;
+		Options();
+	};
+
+	struct Result {
+		// False if original solution is not valid or does not solve the level.
+		bool valid;
+		// LURD string.
+		std::string solution;
+		int moves_before, pushes_before;
+		int moves, pushes;
+		int windows, improvements;
+		// Windows that Solver could not finish (timeout, too large level etc.), they are left as they were.
+		// When it equals windows, solution was only rebuilt with shortest walks.
+		int unsolved_windows;
+		double seconds;
+		Result() : valid(false), moves_before(0), pushes_before(0), moves(0), pushes(0), windows(0), improvements(0), unsolved_windows(0), seconds(0) {}
+	};
+
+	explicit Optimizer(const Sokoban & sokoban);
+	Result optimize(const std::string & solution, const Options & options) const;
+private:
+	struct Push {
+		// Cell of the box before push.
+		int box, direction;
+	};
+
+	LevelMap map;
+	std::vector<int> start_boxes;
+	int start_player;
+
+	bool parsePushes(const std::string & solution, std::vector<Push> & pushes) const;
+	bool composeSolution(const std::vector<Push> & pushes, std::string & solution) const;
+};
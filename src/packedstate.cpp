@@ -0,0 +1,109 @@
+#include "packedstate.h"
+#include "sokoban.h"
+#include <cstring>
+
+namespace {
+
+const size_t INITIAL_TABLE_SIZE = 1024;
+const uint64_t HASH_MULTIPLIER = 0x9e3779b97f4a7c15ull;
+
+uint64_t mix(uint64_t value)
+{
+	value ^= value >> 32;
+	value *= HASH_MULTIPLIER;
+	return value ^ (value >> 29);
+}
+
+}
+
+std::vector<uint16_t> PackedState::fromSokoban(const LevelMap & map, const Sokoban & sokoban)
+{
+	std::vector<int> boxes = map.getBoxIndices(sokoban);
+	std::vector<uint16_t> result(boxes.begin(), boxes.end());
+	result.push_back(map.getPlayerIndex(sokoban));
+	return result;
+}
+
+Sokoban PackedState::toSokoban(const LevelMap & map, const Sokoban & level, const uint16_t * state)
+{
+	unsigned box_count = level.getBoxes().size();
+	std::vector<Chthon::Point> boxes(box_count);
+	for(unsigned i = 0; i < box_count; ++i) {
+		boxes[i] = map.getCellPos(state[i]);
+	}
+	Sokoban result = level;
+	result.setPosition(map.getCellPos(state[box_count]), boxes);
+	return result;
+}
+
+size_t PackedState::hash(const uint16_t * state, unsigned size)
+{
+	uint64_t result = size;
+	unsigned i = 0;
+	for(; i + 4 <= size; i += 4) {
+		uint64_t chunk;
+		memcpy(&chunk, state + i, sizeof(chunk));
+		result = (result ^ chunk) * HASH_MULTIPLIER;
+	}
+	uint64_t tail = 0;
+	memcpy(&tail, state + i, (size - i) * sizeof(uint16_t));
+	return mix(result ^ tail);
+}
+
+bool PackedState::equal(const uint16_t * a, const uint16_t * b, unsigned size)
+{
+	return memcmp(a, b, size * sizeof(uint16_t)) == 0;
+}
+
+StateArena::StateArena(unsigned arena_state_size)
+	: state_size(arena_state_size), count(0), table(INITIAL_TABLE_SIZE, NOT_FOUND)
+{
+}
+
+size_t StateArena::findSlot(const uint16_t * state, size_t hash) const
+{
+	size_t mask = table.size() - 1;
+	for(size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+		if(table[slot] == NOT_FOUND || PackedState::equal(get(table[slot]), state, state_size)) {
+			return slot;
+		}
+	}
+}
+
+unsigned StateArena::find(const uint16_t * state) const
+{
+	return table[findSlot(state, PackedState::hash(state, state_size))];
+}
+
+unsigned StateArena::insert(const uint16_t * state, bool & added)
+{
+	size_t slot = findSlot(state, PackedState::hash(state, state_size));
+	if(table[slot] != NOT_FOUND) {
+		added = false;
+		return table[slot];
+	}
+	added = true;
+	words.insert(words.end(), state, state + state_size);
+	table[slot] = count++;
+	// Load factor is kept under 3/4.
+	if(size_t(count) * 4 > table.size() * 3) {
+		grow();
+	}
+	return count - 1;
+}
+
+void StateArena::grow()
+{
+	std::vector<unsigned> old_table(table.size() * 2, NOT_FOUND);
+	old_table.swap(table);
+	for(unsigned index : old_table) {
+		if(index != NOT_FOUND) {
+			table[findSlot(get(index), PackedState::hash(get(index), state_size))] = index;
+		}
+	}
+}
+
+size_t StateArena::getMemoryBytes() const
+{
+	return words.capacity() * sizeof(uint16_t) + table.size() * sizeof(unsigned);
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "levelmap.h"
+#include <cstdint>
+#include <vector>
+class Sokoban;
+
+// Compact search state: sorted LevelMap indices of boxes followed by player index, 16 bits each.
+// Level with N boxes takes 2 * (N + 1) bytes per state instead of vector of Objects.
+// Levels with more than MAX_CELLS non-wall cells cannot be packed.
+class PackedState {
+public:
+	enum { MAX_CELLS = 0xffff };
+
+	static bool canPack(const LevelMap & map) { return map.getCellCount() <= MAX_CELLS; }
+	static unsigned getSize(unsigned box_count) { return box_count + 1; }
+	// Player is stored as is, search may replace it with normalized one.
+	static std::vector<uint16_t> fromSokoban(const LevelMap & map, const Sokoban & sokoban);
+	// Walls and goals are taken from the level, boxes and player from the state.
+	// Copies the level once and moves its objects, so it costs one copy of the cell table.
+	static Sokoban toSokoban(const LevelMap & map, const Sokoban & level, const uint16_t * state);
+
+	// Both work on whole 64-bit words where possible.
+	static size_t hash(const uint16_t * state, unsigned size);
+	static bool equal(const uint16_t * a, const uint16_t * b, unsigned size);
+};
+
+// Flat storage for states of the same size with a hash set over them.
+// States are never removed, index of a state stays valid until the arena is destroyed.
+class StateArena {
+public:
+	enum { NOT_FOUND = 0xffffffffu };
+
+	explicit StateArena(unsigned state_size);
+
+	unsigned getStateSize() const { return state_size; }
+	unsigned size() const { return count; }
+	const uint16_t * get(unsigned index) const { return &words[size_t(index) * state_size]; }
+	unsigned find(const uint16_t * state) const;
+	// Returns index of equal state, adding a copy of the state if there is none.
+	unsigned insert(const uint16_t * state, bool & added);
+	size_t getMemoryBytes() const;
+private:
+	unsigned state_size;
+	unsigned count;
+	std::vector<uint16_t> words;
+	// Open addressing by state index, size is a power of two.
+	std::vector<unsigned> table;
+
+	size_t findSlot(const uint16_t * state, size_t hash) const;
+	void grow();
+};
@@ -1,45 +1,160 @@
 #include "sokoban.h"
 #include "sprites.h"
 #include "playingmode.h"
+#include "profiler.h"
 #include <chthon2/format.h>
 #include <chthon2/util.h>
 #include <SDL2/SDL.h>
+#include <algorithm>
 #include <iostream>
 
 const int MIN_SCALE_FACTOR = 1;
 const int MAX_SCALE_FACTOR = 8;
+const int HUD_WIDTH = 32;
+const int HUD_MARGIN = 8;
+const int SCROLL_MARGIN = 3;
+// Dead boxes are drawn with green and blue channels reduced to this value.
+const Uint8 DEAD_BOX_TINT = 96;
 
-Game::Game(const Sokoban & prepared_sokoban, const Sprites & _sprites)
-	: original_sprites(_sprites), toInvalidate(true),
+Game::Game(const Sokoban & prepared_sokoban, const std::shared_ptr<const LevelMap> & level_map, const Sprites & _sprites)
+	: original_sprites(_sprites), scale_factor(1), tileset(0), tileset_scale(1),
+	toInvalidate(true),
+	screen_width(0), screen_height(0), background(0),
+	view_width(0), view_height(0),
 	sokoban(prepared_sokoban), target_mode(false),
-	fader_in(640), fader_out(640)
+	fader_in(640), fader_out(640),
+	hud(_sprites, HUD_WIDTH, 1),
+	show_hint(false), shown_hint_status(HintEngine::NONE),
+	hint_line(_sprites, HUD_WIDTH, 1)
 {
 	fader_in.start();
+	updateHud();
+	hints.setLevel(sokoban, level_map);
+	deadlocks.setLevel(sokoban, level_map);
 }
 
-void Game::load(const Sokoban & prepared_sokoban)
+Game::~Game()
+{
+	if(background) {
+		SDL_DestroyTexture(background);
+	}
+}
+
+void Game::load(const Sokoban & prepared_sokoban, const std::shared_ptr<const LevelMap> & level_map)
 {
 	fader_in.start();
 	sokoban = prepared_sokoban;
 	target_mode = false;
 	toInvalidate = true;
+	updateHud();
+	show_hint = false;
+	hints.setLevel(sokoban, level_map);
+	deadlocks.setLevel(sokoban, level_map);
+	dead_boxes.clear();
+}
+
+void Game::invalidate()
+{
+	toInvalidate = true;
+	hud.invalidate();
+	hint_line.invalidate();
+}
+
+void Game::updateHud()
+{
+	hud.set_text(Chthon::format("Moves: {0} Pushes: {1}", sokoban.getHistoryMoves(), sokoban.getHistoryPushes()));
+}
+
+void Game::updateHintLine(const HintEngine::Hint & hint)
+{
+	static const char * DIRECTION_NAMES[] = { "left", "right", "down", "up" };
+	shown_hint_status = hint.status;
+	switch(hint.status) {
+		case HintEngine::NONE: hint_line.set_text(""); break;
+		case HintEngine::SEARCHING: hint_line.set_text("Thinking..."); break;
+		case HintEngine::PUSH: hint_line.set_text(Chthon::format("Hint: push {0}", DIRECTION_NAMES[hint.direction])); break;
+		case HintEngine::LOST: hint_line.set_text("Position is lost"); break;
+		case HintEngine::UNKNOWN: hint_line.set_text("No hint"); break;
+	}
+}
+
+// Only boxes next to the player could change since the last check (pushed or returned by undo),
+// and boxes that were dead before. Detector moves only the pushed box in its own cells, so apart from restart
+// the cost depends on the number of boxes around the checked ones, not on the whole level.
+void Game::updateDeadBoxes()
+{
+	PROFILE_SCOPE("Game::updateDeadBoxes");
+	std::vector<Chthon::Point> boxes_to_check = dead_boxes;
+	Chthon::Point player = sokoban.getPlayerPos();
+	boxes_to_check.push_back(player + Chthon::Point(-1, 0));
+	boxes_to_check.push_back(player + Chthon::Point(1, 0));
+	boxes_to_check.push_back(player + Chthon::Point(0, -1));
+	boxes_to_check.push_back(player + Chthon::Point(0, 1));
+	dead_boxes = deadlocks.check(sokoban, boxes_to_check);
+}
+
+bool Game::isDead(const Chthon::Point & box_pos) const
+{
+	return std::find(dead_boxes.begin(), dead_boxes.end(), box_pos) != dead_boxes.end();
 }
 
 void Game::resizeSpritesForLevel(const SDL_Rect & rect)
 {
 	SDL_Rect originalSize = original_sprites.getSpritesBounds();
-	int scaleFactor = std::min(
+	scale_factor = std::min(
 			rect.w / (sokoban.width() * originalSize.w),
 			rect.h / (sokoban.height() * originalSize.h)
 			);
-	scaleFactor = Chthon::bound(MIN_SCALE_FACTOR, scaleFactor, MAX_SCALE_FACTOR);
+	scale_factor = Chthon::bound(MIN_SCALE_FACTOR, scale_factor, MAX_SCALE_FACTOR);
 
-	sprite_width = originalSize.w * scaleFactor;
-	sprite_height = originalSize.h * scaleFactor;
+	sprite_width = originalSize.w * scale_factor;
+	sprite_height = originalSize.h * scale_factor;
+
+	// Levels that do not fit even at minimal scale are scrolled.
+	view_width = std::min(sokoban.width(), std::max(1, rect.w / sprite_width));
+	view_height = std::min(sokoban.height(), std::max(1, rect.h / sprite_height));
+	camera = Chthon::Point(0, 0);
+}
+
+void Game::updateCamera()
+{
+	Chthon::Point focus = target_mode ? target : sokoban.getPlayerPos();
+	int margin_x = std::min(SCROLL_MARGIN, (view_width - 1) / 2);
+	int margin_y = std::min(SCROLL_MARGIN, (view_height - 1) / 2);
+	if(focus.x < camera.x + margin_x) {
+		camera.x = focus.x - margin_x;
+	} else if(focus.x >= camera.x + view_width - margin_x) {
+		camera.x = focus.x - view_width + margin_x + 1;
+	}
+	if(focus.y < camera.y + margin_y) {
+		camera.y = focus.y - margin_y;
+	} else if(focus.y >= camera.y + view_height - margin_y) {
+		camera.y = focus.y - view_height + margin_y + 1;
+	}
+	camera.x = Chthon::bound(0, camera.x, sokoban.width() - view_width);
+	camera.y = Chthon::bound(0, camera.y, sokoban.height() - view_height);
+}
+
+bool Game::isVisible(const Chthon::Point & cell_pos) const
+{
+	return camera.x <= cell_pos.x && cell_pos.x < camera.x + view_width
+		&& camera.y <= cell_pos.y && cell_pos.y < camera.y + view_height;
+}
+
+void Game::updateTileSet()
+{
+	// Pre-scaled atlas makes every blit a 1:1 copy.
+	tileset = original_sprites.getScaledTileSet(scale_factor);
+	tileset_scale = scale_factor;
+	if(!tileset) {
+		tileset = original_sprites.getTileSet();
+		tileset_scale = 1;
+	}
 }
 
 void Game::processControl(int control)
 {
+	PROFILE_SCOPE("Game::processControl");
 	if(sokoban.isSolved()) {
 		return;
 	}
@@ -57,7 +172,8 @@ void Game::processControl(int control)
 			case CONTROL_GOTO:
 				sokoban.movePlayer(Chthon::Point(target.x, target.y));
 				target_mode = false;
-				break;
+				updateAfterMove();
+				return;
 			case CONTROL_TARGET:  target_mode = false; break;
 			case CONTROL_ESCAPE:  target_mode = false; break;
 			default: break;
@@ -86,7 +202,11 @@ void Game::processControl(int control)
 			target = Chthon::Point(player.x, player.y);
 			break;
 		}
-		case CONTROL_HOME: sokoban.restart(); break;
+		case CONTROL_HOME:
+			sokoban.restart();
+			deadlocks.setPosition(sokoban);
+			break;
+		case CONTROL_HINT: show_hint = true; return;
 		case CONTROL_UNDO:
 			try {
 				sokoban.undo();
@@ -96,6 +216,17 @@ void Game::processControl(int control)
 			break;
 		default: return;
 	}
+	updateAfterMove();
+}
+
+// Everything that follows the position: the same for keys and for goto in target mode.
+void Game::updateAfterMove()
+{
+	// Hint is shown until the next move, search for the new position starts right away.
+	show_hint = false;
+	hints.setPosition(sokoban);
+	updateDeadBoxes();
+	updateHud();
 	if(sokoban.isSolved()) {
 		fader_out.start();
 	}
@@ -106,23 +237,33 @@ bool Game::is_done() const
 	return sokoban.isSolved() && !fader_out.is_active();
 }
 
-void Game::paint(SDL_Renderer * painter, const SDL_Rect & rect)
+bool Game::is_animating() const
 {
-	if(toInvalidate) {
-		resizeSpritesForLevel(rect);
-		toInvalidate = false;
+	// Hint is polled until it is ready and painted.
+	if(show_hint) {
+		HintEngine::Status status = hints.getHint().status;
+		if(status == HintEngine::SEARCHING || status != shown_hint_status) {
+			return true;
+		}
 	}
+	return fader_in.is_active() || fader_out.is_active();
+}
 
-	SDL_RenderClear(painter);
-
-	Chthon::Point offset = Chthon::Point(
-			rect.w - sokoban.width() * sprite_width,
-			rect.h - sokoban.height() * sprite_height
-			) / 2;
-	for(int y = 0; y < sokoban.height(); ++y) {
-		for(int x = 0; x < sokoban.width(); ++x) {
-			Chthon::Point pos = offset + Chthon::Point(x * sprite_width, y * sprite_height);
+void Game::paintSprite(const Chthon::Point & offset, const Chthon::Point & cell_pos, int sprite, int index)
+{
+	SDL_Rect src_rect = original_sprites.getSpriteRect(sprite, index, tileset_scale);
+	SDL_Rect dest_rect;
+	dest_rect.x = offset.x + (cell_pos.x - camera.x) * sprite_width;
+	dest_rect.y = offset.y + (cell_pos.y - camera.y) * sprite_height;
+	dest_rect.w = sprite_width;
+	dest_rect.h = sprite_height;
+	batch.add(tileset, src_rect, dest_rect);
+}
 
+void Game::paintBackground(const Chthon::Point & offset)
+{
+	for(int y = camera.y; y < camera.y + view_height; ++y) {
+		for(int x = camera.x; x < camera.x + view_width; ++x) {
 			Cell cell = sokoban.getCellAt(x, y);
 			int cellSprite = Sprites::SPACE;
 			switch(cell.type) {
@@ -132,50 +273,144 @@ void Game::paint(SDL_Renderer * painter, const SDL_Rect & rect)
 				case Cell::WALL: cellSprite = Sprites::WALL; break;
 			}
 			cellSprite = original_sprites.contains(cellSprite) ? cellSprite : Sprites::SPACE;
+			paintSprite(offset, Chthon::Point(x, y), cellSprite, cell.sprite);
+		}
+	}
+}
 
-			SDL_Rect src_rect = original_sprites.getSpriteRect(cellSprite, cell.sprite);
-			SDL_Rect dest_rect;
-			dest_rect.x = pos.x;
-			dest_rect.y = pos.y;
-			dest_rect.w = sprite_width;
-			dest_rect.h = sprite_height;
-			SDL_RenderCopy(painter, original_sprites.getTileSet(), &src_rect, &dest_rect);
-
-			Object object = sokoban.getObjectAt(x, y);
-			if(!object.isNull()) {
-				int objectSprite = Sprites::SPACE;
-				switch(cell.type) {
-					case Cell::FLOOR:
-						if(object.is_player) {
-							objectSprite = Sprites::PLAYER_ON_FLOOR;
-						} else {
-							objectSprite = Sprites::BOX_ON_FLOOR;
-						}
-						break;
-					case Cell::SLOT:
-						if(object.is_player) {
-							objectSprite = Sprites::PLAYER_ON_SLOT;
-						} else {
-							objectSprite = Sprites::BOX_ON_SLOT;
-						}
-						break;
-				}
-				if(objectSprite != Sprites::SPACE && original_sprites.contains(objectSprite)) {
-					SDL_Rect src_rect = original_sprites.getSpriteRect(objectSprite, object.sprite);
-					SDL_RenderCopy(painter, original_sprites.getTileSet(), &src_rect, &dest_rect);
-				}
+void Game::paintObject(const Chthon::Point & offset, const Object & object)
+{
+	if(!isVisible(object.pos)) {
+		return;
+	}
+	int objectSprite = Sprites::SPACE;
+	switch(sokoban.getCellAt(object.pos).type) {
+		case Cell::FLOOR:
+			if(object.is_player) {
+				objectSprite = Sprites::PLAYER_ON_FLOOR;
+			} else {
+				objectSprite = Sprites::BOX_ON_FLOOR;
 			}
+			break;
+		case Cell::SLOT:
+			if(object.is_player) {
+				objectSprite = Sprites::PLAYER_ON_SLOT;
+			} else {
+				objectSprite = Sprites::BOX_ON_SLOT;
+			}
+			break;
+	}
+	if(objectSprite != Sprites::SPACE && original_sprites.contains(objectSprite)) {
+		paintSprite(offset, object.pos, objectSprite, object.sprite);
+	}
+}
+
+void Game::updateBackground(SDL_Renderer * painter)
+{
+	PROFILE_SCOPE("Game::updateBackground");
+	// Walls, floors and slots never change during level, so they are rendered once per visible area.
+	background_camera = camera;
+	int width = view_width * sprite_width;
+	int height = view_height * sprite_height;
+	int old_width = 0, old_height = 0;
+	if(background) {
+		SDL_QueryTexture(background, 0, 0, &old_width, &old_height);
+	}
+	if(old_width != width || old_height != height) {
+		if(background) {
+			SDL_DestroyTexture(background);
+		}
+		background = SDL_CreateTexture(painter, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+	}
+	if(!background) {
+		return;
+	}
+	SDL_Texture * old_target = SDL_GetRenderTarget(painter);
+	if(SDL_SetRenderTarget(painter, background) != 0) {
+		SDL_DestroyTexture(background);
+		background = 0;
+		return;
+	}
+	SDL_SetRenderDrawColor(painter, 0, 0, 0, 255);
+	SDL_RenderClear(painter);
+	batch.begin(painter);
+	paintBackground(Chthon::Point(0, 0));
+	batch.end();
+	SDL_SetRenderTarget(painter, old_target);
+}
+
+void Game::paint(SDL_Renderer * painter, const SDL_Rect & rect)
+{
+	PROFILE_SCOPE("Game::paint");
+	bool resized = toInvalidate || rect.w != screen_width || rect.h != screen_height;
+	if(resized) {
+		screen_width = rect.w;
+		screen_height = rect.h;
+		resizeSpritesForLevel(rect);
+	}
+	updateTileSet();
+	updateCamera();
+	if(resized || camera != background_camera) {
+		updateBackground(painter);
+		toInvalidate = false;
+	}
+
+	SDL_SetRenderDrawColor(painter, 0, 0, 0, 255);
+	SDL_RenderClear(painter);
+
+	Chthon::Point offset = Chthon::Point(
+			rect.w - view_width * sprite_width,
+			rect.h - view_height * sprite_height
+			) / 2;
+	batch.begin(painter);
+	if(background) {
+		SDL_Rect src_rect;
+		src_rect.x = 0;
+		src_rect.y = 0;
+		src_rect.w = view_width * sprite_width;
+		src_rect.h = view_height * sprite_height;
+		SDL_Rect dest_rect = src_rect;
+		dest_rect.x = offset.x;
+		dest_rect.y = offset.y;
+		batch.add(background, src_rect, dest_rect);
+	} else {
+		paintBackground(offset);
+	}
+	for(const Object & box : sokoban.getBoxes()) {
+		if(!isDead(box.pos)) {
+			paintObject(offset, box);
 		}
 	}
+	paintObject(offset, sokoban.getPlayer());
+	batch.end();
+
+	if(!dead_boxes.empty()) {
+		SDL_SetTextureColorMod(tileset, 255, DEAD_BOX_TINT, DEAD_BOX_TINT);
+		batch.begin(painter);
+		for(const Chthon::Point & box_pos : dead_boxes) {
+			paintObject(offset, sokoban.getObjectAt(box_pos));
+		}
+		batch.end();
+		SDL_SetTextureColorMod(tileset, 255, 255, 255);
+	}
+
+	batch.begin(painter);
 	if(target_mode) {
-		Chthon::Point pos = offset + Chthon::Point(target.x * sprite_width, target.y * sprite_height);
-		SDL_Rect src_rect = original_sprites.getSpriteRect(Sprites::CURSOR, 0);
-		SDL_Rect dest_rect;
-		dest_rect.x = pos.x;
-		dest_rect.y = pos.y;
-		dest_rect.w = sprite_width;
-		dest_rect.h = sprite_height;
-		SDL_RenderCopy(painter, original_sprites.getTileSet(), &src_rect, &dest_rect);
+		paintSprite(offset, target, Sprites::CURSOR, 0);
+	}
+	HintEngine::Hint hint;
+	if(show_hint) {
+		hint = hints.getHint();
+		if(hint.status == HintEngine::PUSH && isVisible(hint.box)) {
+			paintSprite(offset, hint.box, Sprites::CURSOR, 0);
+		}
+	}
+	batch.end();
+	hud.paint(painter, rect.x + HUD_MARGIN, rect.y + HUD_MARGIN);
+	if(show_hint) {
+		updateHintLine(hint);
+		int line_height = TextCache::getTextRect(original_sprites, " ", 1).h;
+		hint_line.paint(painter, rect.x + HUD_MARGIN, rect.y + HUD_MARGIN + line_height);
 	}
 
 	if(fader_in.is_active() || fader_out.is_active()) {
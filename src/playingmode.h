@@ -2,7 +2,12 @@
 #include "sokoban.h"
 #include "sprites.h"
 #include "counter.h"
+#include "spritebatch.h"
+#include "textcache.h"
+#include "hintengine.h"
+#include "deadlock.h"
 class SDL_Rect;
+class SDL_Texture;
 
 class Game {
 public:
@@ -14,29 +19,67 @@ public:
 		CONTROL_TARGET, CONTROL_GOTO,
 		CONTROL_UNDO, CONTROL_HOME, CONTROL_QUIT,
 		CONTROL_ESCAPE,
-		CONTROL_CHEAT_RESTART, CONTROL_CHEAT_SKIP_LEVEL
+		CONTROL_CHEAT_RESTART, CONTROL_CHEAT_SKIP_LEVEL,
+		CONTROL_TOGGLE_OVERLAY,
+		CONTROL_HINT
 	} Control;
 
-	Game(const Sokoban & prepared_sokoban, const Sprites & sprites);
-	virtual ~Game() {}
+	// Map is shared by hint engine and deadlock detector, it is prepared with the level (see LevelSet).
+	Game(const Sokoban & prepared_sokoban, const std::shared_ptr<const LevelMap> & level_map, const Sprites & sprites);
+	virtual ~Game();
 
-	void load(const Sokoban & prepared_sokoban);
+	void load(const Sokoban & prepared_sokoban, const std::shared_ptr<const LevelMap> & level_map);
 	virtual void paint(SDL_Renderer * painter, const SDL_Rect & rect);
 	virtual void processControl(int control);
 	virtual bool is_done() const;
+	bool is_animating() const;
 	void processTime(int msec_passed);
+	void invalidate();
+	const Sokoban & getSokoban() const { return sokoban; }
 private:
 	const Sprites & original_sprites;
+	int scale_factor;
 	int sprite_width;
 	int sprite_height;
+	SDL_Texture * tileset;
+	int tileset_scale;
 	bool toInvalidate;
+	int screen_width;
+	int screen_height;
+	SDL_Texture * background;
+	Chthon::Point background_camera;
+	SpriteBatch batch;
+	Chthon::Point camera;
+	int view_width;
+	int view_height;
 	Sokoban sokoban;
 	bool target_mode;
 	Chthon::Point target;
 
 	Counter fader_in;
 	Counter fader_out;
+	TextLine hud;
+	HintEngine hints;
+	bool show_hint;
+	HintEngine::Status shown_hint_status;
+	TextLine hint_line;
+	DeadlockDetector deadlocks;
+	std::vector<Chthon::Point> dead_boxes;
 
+	Game(const Game &) = delete;
+	Game & operator=(const Game &) = delete;
 	void resizeSpritesForLevel(const SDL_Rect & rect);
+	void updateHud();
+	void updateAfterMove();
+	void updateHintLine(const HintEngine::Hint & hint);
+	void updateDeadBoxes();
+	bool isDead(const Chthon::Point & box_pos) const;
+	void updateCamera();
+	bool isVisible(const Chthon::Point & cell_pos) const;
+	void updateTileSet();
+	void updateBackground(SDL_Renderer * painter);
+	void paintBackground(const Chthon::Point & offset);
+	void paintObject(const Chthon::Point & offset, const Object & object);
+	void paintSprite(const Chthon::Point & offset, const Chthon::Point & cell_pos, int sprite, int index);
 };
 
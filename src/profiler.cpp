@@ -0,0 +1,103 @@
+#include "profiler.h"
+#ifdef MINIBAN_PROFILE
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <functional>
+
+namespace {
+
+const unsigned MAX_EVENTS = 1 << 20;
+const unsigned MAX_FRAMES = 120;
+
+std::mutex mutex;
+std::vector<Profiler::Event> events;
+unsigned next_event = 0;
+std::vector<long long> frame_times;
+unsigned next_frame = 0;
+int last_draw_calls = 0;
+std::map<std::string, long long> last_durations;
+
+const std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+}
+
+namespace Profiler {
+
+long long now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void record(const char * name, long long start_usec, long long duration_usec)
+{
+	Event event;
+	event.name = name;
+	event.start_usec = start_usec;
+	event.duration_usec = duration_usec;
+	event.thread = std::hash<std::thread::id>()(std::this_thread::get_id()) % 100000;
+
+	std::lock_guard<std::mutex> lock(mutex);
+	// Oldest events are overwritten when buffer is full.
+	if(events.size() < MAX_EVENTS) {
+		events.push_back(event);
+	} else {
+		events[next_event] = event;
+	}
+	next_event = (next_event + 1) % MAX_EVENTS;
+	last_durations[name] = duration_usec;
+}
+
+void frameFinished(long long frame_usec, int draw_calls)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if(frame_times.size() < MAX_FRAMES) {
+		frame_times.push_back(frame_usec);
+	} else {
+		frame_times[next_frame] = frame_usec;
+	}
+	next_frame = (next_frame + 1) % MAX_FRAMES;
+	last_draw_calls = draw_calls;
+}
+
+std::vector<long long> getFrameTimes()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::vector<long long> result;
+	for(unsigned i = 0; i < frame_times.size(); ++i) {
+		result.push_back(frame_times[(next_frame + i) % frame_times.size()]);
+	}
+	return result;
+}
+
+int getLastDrawCalls()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return last_draw_calls;
+}
+
+std::map<std::string, long long> getLastDurations()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return last_durations;
+}
+
+bool exportChromeTrace(const std::string & file_name)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::ofstream file(file_name.c_str(), std::ofstream::out);
+	file << "{\"traceEvents\":[\n";
+	for(unsigned i = 0; i < events.size(); ++i) {
+		const Event & event = events[(next_event + i) % events.size()];
+		file << (i > 0 ? "," : "")
+			<< "{\"name\":\"" << event.name << "\",\"ph\":\"X\""
+			<< ",\"ts\":" << event.start_usec << ",\"dur\":" << event.duration_usec
+			<< ",\"pid\":1,\"tid\":" << event.thread << "}\n";
+	}
+	file << "]}\n";
+	return bool(file);
+}
+
+}
+#endif
@@ -0,0 +1,45 @@
+#pragma once
+// Scoped timing instrumentation.
+// It is compiled in only when MINIBAN_PROFILE is defined (make PROFILE=1),
+// otherwise PROFILE_SCOPE expands to nothing.
+
+#ifdef MINIBAN_PROFILE
+#include <string>
+#include <vector>
+#include <map>
+
+namespace Profiler {
+
+struct Event {
+	const char * name;
+	long long start_usec;
+	long long duration_usec;
+	unsigned thread;
+};
+
+long long now();
+void record(const char * name, long long start_usec, long long duration_usec);
+void frameFinished(long long frame_usec, int draw_calls);
+
+std::vector<long long> getFrameTimes();
+int getLastDrawCalls();
+std::map<std::string, long long> getLastDurations();
+bool exportChromeTrace(const std::string & file_name);
+
+class Scope {
+public:
+	Scope(const char * scope_name) : name(scope_name), start(now()) {}
+	~Scope() { record(name, start, now() - start); }
+private:
+	const char * name;
+	long long start;
+};
+
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_SCOPE(name) Profiler::Scope PROFILE_CONCAT(profile_scope_, __LINE__)(name)
+#else
+#define PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,67 @@
+#include "profileroverlay.h"
+#ifdef MINIBAN_PROFILE
+#include "profiler.h"
+#include "sprites.h"
+#include "textcache.h"
+#include <chthon2/format.h>
+
+namespace {
+
+const int PANEL_WIDTH = 480;
+const int HISTOGRAM_HEIGHT = 100;
+const int USEC_PER_PIXEL = 333;
+const int FRAME_BUDGET_USEC = 16667;
+
+}
+
+ProfilerOverlay::ProfilerOverlay(const Sprites & _sprites)
+	: sprites(_sprites)
+{
+}
+
+void ProfilerOverlay::paint(SDL_Renderer * painter, const SDL_Rect & rect)
+{
+	SDL_Rect panel;
+	panel.w = PANEL_WIDTH;
+	panel.h = rect.h;
+	panel.x = rect.x + rect.w - panel.w;
+	panel.y = rect.y;
+	SDL_SetRenderDrawColor(painter, 0, 0, 0, 192);
+	SDL_RenderFillRect(painter, &panel);
+
+	std::vector<long long> frame_times = Profiler::getFrameTimes();
+	bars.clear();
+	long long last_frame = 0;
+	for(unsigned i = 0; i < frame_times.size(); ++i) {
+		SDL_Rect bar;
+		bar.w = PANEL_WIDTH / 120;
+		bar.h = std::min<long long>(HISTOGRAM_HEIGHT, frame_times[i] / USEC_PER_PIXEL + 1);
+		bar.x = panel.x + i * bar.w;
+		bar.y = panel.y + HISTOGRAM_HEIGHT - bar.h;
+		bars.push_back(bar);
+		last_frame = frame_times[i];
+	}
+	SDL_SetRenderDrawColor(painter, 0, 255, 0, 255);
+	if(!bars.empty()) {
+		SDL_RenderFillRects(painter, &bars[0], bars.size());
+	}
+	SDL_Rect budget_line = { panel.x, panel.y + HISTOGRAM_HEIGHT - FRAME_BUDGET_USEC / USEC_PER_PIXEL, panel.w, 1 };
+	SDL_SetRenderDrawColor(painter, 255, 0, 0, 255);
+	SDL_RenderFillRect(painter, &budget_line);
+
+	std::vector<std::string> lines;
+	lines.push_back(Chthon::format("Frame: {0} usec", last_frame));
+	lines.push_back(Chthon::format("Draw calls: {0}", Profiler::getLastDrawCalls()));
+	for(const auto & key_value : Profiler::getLastDurations()) {
+		lines.push_back(Chthon::format("{0}: {1}", key_value.first, key_value.second));
+	}
+	batch.begin(painter);
+	int y = panel.y + HISTOGRAM_HEIGHT;
+	for(const std::string & line : lines) {
+		TextCache::paintText(batch, sprites, line, panel.x, y, 1);
+		y += sprites.getCharRect(0).h;
+	}
+	batch.end();
+	SDL_SetRenderDrawColor(painter, 0, 0, 0, 255);
+}
+#endif
@@ -0,0 +1,17 @@
+#pragma once
+#ifdef MINIBAN_PROFILE
+#include "spritebatch.h"
+#include <vector>
+class Sprites;
+
+// On-screen panel with frame time histogram, draw calls and last cost of every profiled scope.
+class ProfilerOverlay {
+public:
+	ProfilerOverlay(const Sprites & _sprites);
+	void paint(SDL_Renderer * painter, const SDL_Rect & rect);
+private:
+	const Sprites & sprites;
+	SpriteBatch batch;
+	std::vector<SDL_Rect> bars;
+};
+#endif
@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 
+std::string get_xdg_config_dir();
+
 struct Settings {
 	int level_index;
 	std::string levelset;
@@ -1,16 +1,61 @@
 #include "sokoban.h"
+#include "profiler.h"
 #include <chthon2/pathfinding.h>
 #include <chthon2/util.h>
 #include <chthon2/log.h>
 #include <algorithm>
 #include <sstream>
+#include <cctype>
 #include <map>
 #include <set>
+#ifdef MINIBAN_COUNTERS
+#include <chrono>
+#endif
 
 static const bool DIRECTIONAL_PLAYER_SPRITES = false;
 
+#ifdef MINIBAN_COUNTERS
+namespace {
+
+// Adds duration of the outermost timed call to the counter, nested calls are already covered by it.
+class CounterTimer {
+public:
+	CounterTimer(long long & counter_nsec, bool & is_timing)
+		: counter(counter_nsec), timing(is_timing), outermost(!is_timing), start(std::chrono::steady_clock::now())
+	{
+		timing = true;
+	}
+	~CounterTimer()
+	{
+		if(outermost) {
+			counter += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+			timing = false;
+		}
+	}
+private:
+	long long & counter;
+	bool & timing;
+	bool outermost;
+	std::chrono::steady_clock::time_point start;
+};
+
+}
+#define COUNT(counter) ++counters.counter
+#define COUNT_TIME(counter) CounterTimer counter_timer(counters.counter, timing_counters)
+#else
+#define COUNT(counter)
+#define COUNT_TIME(counter)
+#endif
+
+Sokoban::Counters::Counters()
+	: moves(0), pushes(0), undos(0), loads(0),
+	pathfinding_calls(0), visited_cells(0),
+	move_nsec(0), undo_nsec(0), pathfinding_nsec(0), load_nsec(0)
+{
+}
+
 Sokoban::Sokoban()
-	: valid(false), cells(1, 1)
+	: valid(false), cells(1, 1), history_moves(0), history_pushes(0), timing_counters(false)
 {
 }
 
@@ -31,6 +76,9 @@ bool operator!=(const Cell & a, const Cell & b)
 
 void Sokoban::load(const std::string & levelField, const std::string & backgroundHistory, bool isFullHistoryTracked)
 {
+	PROFILE_SCOPE("Sokoban::load");
+	COUNT(loads);
+	COUNT_TIME(load_nsec);
 	valid = false;
 	std::vector<std::string> rows = Chthon::split(levelField);
 	unsigned h = rows.size();
@@ -96,6 +144,8 @@ void Sokoban::load(const std::string & levelField, const std::string & backgroun
 	}
 	valid = true;
 	history = backgroundHistory;
+	history_moves = std::count_if(history.begin(), history.end(), [](char step) { return isalpha(step) != 0; });
+	history_pushes = std::count_if(history.begin(), history.end(), [](char step) { return isupper(step) != 0; });
 	fullHistoryTracking = isFullHistoryTracked;
 }
 
@@ -105,6 +155,17 @@ void Sokoban::restart()
 	}
 }
 
+void Sokoban::setPosition(const Chthon::Point & player_pos, const std::vector<Chthon::Point> & box_positions)
+{
+	player.pos = player_pos;
+	boxes.resize(box_positions.size());
+	for(unsigned i = 0; i < boxes.size(); ++i) {
+		boxes[i].pos = box_positions[i];
+	}
+	history.clear();
+	history_moves = history_pushes = 0;
+}
+
 bool Sokoban::has_box(const Chthon::Point & point) const
 {
 	foreach(const Object & box, boxes) {
@@ -117,13 +178,17 @@ bool Sokoban::has_box(const Chthon::Point & point) const
 
 bool Sokoban::movePlayer(const Chthon::Point & target)
 {
+	PROFILE_SCOPE("Sokoban::goto");
 	if(!valid) {
 		return false;
 	}
+	COUNT(pathfinding_calls);
+	COUNT_TIME(pathfinding_nsec);
 	Chthon::Pathfinder finder(false);
 	bool found = finder.lee(getPlayerPos(), target,
 			[this](const Chthon::Point & p) {
-				return this->cells.cell(p).type != Cell::WALL && !has_box(p);
+				COUNT(visited_cells);
+				return this->cells.valid(p) && this->cells.cell(p).type != Cell::WALL && !has_box(p);
 			});
 	if(!found) {
 		return false;
@@ -172,9 +237,11 @@ bool Sokoban::isValid(const Chthon::Point & pos) const
 
 bool Sokoban::runPlayer(int control)
 {
+	PROFILE_SCOPE("Sokoban::runPlayer");
 	if(!valid) {
 		return false;
 	}
+	COUNT_TIME(move_nsec);
 	bool moved = false;
 	while(movePlayer(control, true)) {
 		moved = true;
@@ -187,6 +254,7 @@ bool Sokoban::movePlayer(int control, bool cautious)
 	if(!valid) {
 		return false;
 	}
+	COUNT_TIME(move_nsec);
 	std::map<int, std::pair<int, int> > diagonal_controls;
 	diagonal_controls[UP_LEFT] = std::make_pair<int, int>(UP, LEFT);
 	diagonal_controls[UP_RIGHT] = std::make_pair<int, int>(UP, RIGHT);
@@ -267,11 +335,17 @@ bool Sokoban::movePlayer(int control, bool cautious)
 			}
 		}
 		controlChar = toupper(controlChar);
+		COUNT(pushes);
 	}
+	COUNT(moves);
 	if(DIRECTIONAL_PLAYER_SPRITES) {
 		player.sprite = poseForControl[control];
 	}
 	history.append(std::string(1, controlChar));
+	++history_moves;
+	if(isupper(controlChar)) {
+		++history_pushes;
+	}
 	return true;
 }
 
@@ -306,9 +380,11 @@ std::string Sokoban::historyAsString() const
 
 bool Sokoban::undo()
 {
+	PROFILE_SCOPE("Sokoban::undo");
 	if(!valid) {
 		return false;
 	}
+	COUNT_TIME(undo_nsec);
 	std::map<char, Chthon::Point> shiftForControl;
 	shiftForControl['u'] = Chthon::Point(0, -1);
 	shiftForControl['d'] = Chthon::Point(0, 1);
@@ -322,14 +398,13 @@ bool Sokoban::undo()
 
 	std::string realHistory = history;
 	if(fullHistoryTracking) {
-		while(!realHistory.empty() && Chthon::ends_with(realHistory, "-")) {
-			int count = 0;
-			while(Chthon::ends_with(realHistory, "-")) {
-				++count;
-				realHistory.erase(realHistory.size() - 1, 1);
-			}
-			while(count > 0) {
-				--count;
+		// Every undo mark cancels the latest step that was not cancelled yet,
+		// so marks cannot be simply counted from the end: "rr-r--" leaves nothing to undo.
+		realHistory.clear();
+		for(char step : history) {
+			if(step != '-') {
+				realHistory += step;
+			} else if(!realHistory.empty()) {
 				realHistory.erase(realHistory.size() - 1, 1);
 			}
 		}
@@ -383,28 +458,32 @@ bool Sokoban::undo()
 		history += '-';
 	} else {
 		history.erase(history.size() - 1, 1);
+		--history_moves;
+		if(isupper(control)) {
+			--history_pushes;
+		}
 	}
+	COUNT(undos);
 	return true;
 }
 
 bool Sokoban::isSolved() const
 {
+	PROFILE_SCOPE("Sokoban::isSolved");
 	if(!valid) {
 		return false;
 	}
-	int freeBoxCount = 0, freeSlotCount = 0;
-	for(int y = 0; y < height(); ++y) {
-		for(int x = 0; x < width(); ++x) {
-			if(cells.cell(Chthon::Point(x, y)).type == Cell::SLOT && !has_box(Chthon::Point(x, y))) {
-				freeSlotCount++;
-			}
+	// Boxes never share a cell, so every box on a slot occupies a distinct slot.
+	int slotCount = 0, boxesOnSlots = 0;
+	for(const Cell & cell : cells) {
+		if(cell.type == Cell::SLOT) {
+			slotCount++;
 		}
 	}
 	foreach(const Object & box, boxes) {
-		if(cells.cell(box.pos).type != Cell::SLOT) {
-			freeBoxCount++;
+		if(cells.cell(box.pos).type == Cell::SLOT) {
+			boxesOnSlots++;
 		}
 	}
-	return (freeBoxCount == 0) && (freeSlotCount == 0);
+	return boxesOnSlots == int(boxes.size()) && boxesOnSlots == slotCount;
 }
-
@@ -34,9 +34,24 @@ public:
 	};
 	class OutOfMapException {};
 
+	// Effort spent on the level, collected only when built with MINIBAN_COUNTERS (make COUNTERS=1),
+	// otherwise all values stay zero.
+	// Time is accounted to the outermost call only: moves made by goto or run count as goto or move time.
+	struct Counters {
+		unsigned moves, pushes, undos, loads;
+		unsigned pathfinding_calls, visited_cells;
+		long long move_nsec, undo_nsec, pathfinding_nsec, load_nsec;
+		Counters();
+	};
+
 	Sokoban();
 	Sokoban(const std::string & levelField, const std::string & backgroundHistory = std::string(), bool isFullHistoryTracked = false);
 	virtual ~Sokoban() {}
+	// Declared destructor turns off implicit moves, and prefetched levels should be moved, not copied.
+	Sokoban(const Sokoban &) = default;
+	Sokoban(Sokoban &&) = default;
+	Sokoban & operator=(const Sokoban &) = default;
+	Sokoban & operator=(Sokoban &&) = default;
 
 	void load(const std::string & levelField, const std::string & backgroundHistory = std::string(), bool isFullHistoryTracked = false);
 
@@ -51,7 +66,12 @@ public:
 
 	std::string toString() const;
 	std::string historyAsString() const;
+	// Letters and uppercase letters of historyAsString(), kept up to date by every step and undo.
+	int getHistoryMoves() const { return history_moves; }
+	int getHistoryPushes() const { return history_pushes; }
 	Chthon::Point getPlayerPos() const;
+	const Object & getPlayer() const { return player; }
+	const std::vector<Object> & getBoxes() const { return boxes; }
 
 	bool undo();
 	bool isSolved() const;
@@ -59,6 +79,12 @@ public:
 	bool movePlayer(const Chthon::Point & target);
 	bool runPlayer(int control);
 	void restart();
+	// Puts player and boxes to given cells and clears history, walls and slots stay.
+	// Box count should be the same as in the level.
+	void setPosition(const Chthon::Point & player_pos, const std::vector<Chthon::Point> & box_positions);
+
+	const Counters & getCounters() const { return counters; }
+	void resetCounters() { counters = Counters(); }
 private:
 	bool valid;
 	std::string original_level;
@@ -66,7 +92,10 @@ private:
 	std::vector<Object> boxes;
 	Chthon::Map<Cell> cells;
 	std::string history;
+	int history_moves, history_pushes;
 	bool has_box(const Chthon::Point & point) const;
 	bool fullHistoryTracking;
+	Counters counters;
+	bool timing_counters;
 	bool shiftPlayer(const Chthon::Point & shift);
 };
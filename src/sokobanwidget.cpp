@@ -1,85 +1,31 @@
 #include "playingmode.h"
 #include "sokobanwidget.h"
 #include "message.h"
+#include "profiler.h"
+#include "profileroverlay.h"
 #include <chthon2/log.h>
 #include <chthon2/format.h>
 #include <SDL2/SDL.h>
 #include <algorithm>
 #include <iostream>
+#include <cstdlib>
 
 namespace {
 
-std::map<int, std::string> generateKeyToTextMap()
-{
-	std::map<int, std::string> result;
-	result[SDLK_0]         = "0";
-	result[SDLK_1]         = "1";
-	result[SDLK_BACKSPACE] = "Backspace";
-	result[SDLK_DOWN]      = "Down";
-	result[SDLK_h]         = "H";
-	result[SDLK_HOME]      = "Home";
-	result[SDLK_j]         = "J";
-	result[SDLK_k]         = "K";
-	result[SDLK_l]         = "L";
-	result[SDLK_y]         = "Y";
-	result[SDLK_u]         = "U";
-	result[SDLK_b]         = "B";
-	result[SDLK_n]         = "N";
-	result[SDLK_LEFT]      = "Left";
-	result[SDLK_o]         = "O";
-	result[SDLK_q]         = "Q";
-	result[SDLK_r]         = "R";
-	result[SDLK_RIGHT]     = "Right";
-	result[SDLK_SPACE]     = "Space";
-	result[SDLK_u]         = "U";
-	result[SDLK_UP]        = "Up";
-	result[SDLK_z]         = "Z";
-	result[SDLK_x]         = "X";
-	result[SDLK_PERIOD]    = ".";
-	result[SDLK_ESCAPE]    = "Esc";
-	return result;
-}
-
-std::map<std::string, int> generateTextToControlMap()
-{
-	std::map<std::string, int> result;
-	result["Left"]  = result["H"] = Game::CONTROL_LEFT;
-	result["Down"]  = result["J"] = Game::CONTROL_DOWN;
-	result["Up"]    = result["K"] = Game::CONTROL_UP;
-	result["Right"] = result["L"] = Game::CONTROL_RIGHT;
-	result["Y"] = Game::CONTROL_UP_LEFT;
-	result["U"] = Game::CONTROL_UP_RIGHT;
-	result["B"] = Game::CONTROL_DOWN_LEFT;
-	result["N"] = Game::CONTROL_DOWN_RIGHT;
-	result["Shift-Left"]  = result["Shift-H"] = Game::CONTROL_RUN_LEFT;
-	result["Shift-Down"]  = result["Shift-J"] = Game::CONTROL_RUN_DOWN;
-	result["Shift-Up"]    = result["Shift-K"] = Game::CONTROL_RUN_UP;
-	result["Shift-Right"] = result["Shift-L"] = Game::CONTROL_RUN_RIGHT;
-	result["X"]         = Game::CONTROL_TARGET;
-	result["."]         = Game::CONTROL_GOTO;
-	result["Space"]     = Game::CONTROL_SKIP;
-	result["Ctrl-Z"]    = Game::CONTROL_UNDO;
-	result["Backspace"] = Game::CONTROL_UNDO;
-	result["Ctrl-R"]    = Game::CONTROL_HOME;
-	result["Home"]      = Game::CONTROL_HOME;
-	result["Ctrl-Q"]    = Game::CONTROL_QUIT;
-	result["Q"]         = Game::CONTROL_QUIT;
-	result["Esc"]       = Game::CONTROL_ESCAPE;
-
-	result["Ctrl-0"]    = Game::CONTROL_CHEAT_RESTART;
-	result["Ctrl-1"]    = Game::CONTROL_CHEAT_SKIP_LEVEL;
-	return result;
-}
-
-std::map<int, std::string> keyToText = generateKeyToTextMap();
-std::map<std::string, int> textToControl = generateTextToControlMap();
+// Safety wake-up for idle loop, nothing should depend on it.
+const int IDLE_WAIT_TIMEOUT = 1000;
+const unsigned MAX_CONTROLS_PER_FRAME = 64;
 
 }
 
 
 SokobanWidget::SokobanWidget(int argc, char ** argv)
-	: quit(false)
+	: quit(false), measure_latency(getenv("MINIBAN_LATENCY") != 0), input_time(0)
 {
+	keymap.loadDefaults();
+	keymap.loadFromFile(get_xdg_config_dir() + "/miniban.keys");
+	pending_controls.reserve(MAX_CONTROLS_PER_FRAME);
+
 	char absolute_file_path[256] = {0};
 	const char * ok = realpath(argv[1], absolute_file_path);
 	std::string commandLineFilename = (argc <= 1 && ok) ? "" : absolute_file_path;
@@ -113,18 +59,27 @@ SokobanWidget::~SokobanWidget()
 
 int SokobanWidget::keyToControl(SDL_KeyboardEvent * event)
 {
-	bool isShiftDown = event->keysym.mod & (KMOD_RSHIFT | KMOD_LSHIFT);
-	bool isCtrlDown = event->keysym.mod & (KMOD_RCTRL | KMOD_LCTRL);
+	return keymap.getControl(event->keysym.sym, event->keysym.mod);
+}
 
-	std::string pressedCombination = keyToText[event->keysym.sym];
-	if(isShiftDown) {
-		pressedCombination = "Shift-" + pressedCombination;
+void SokobanWidget::printLatencyStats()
+{
+	if(latencies.empty()) {
+		return;
 	}
-	if(isCtrlDown) {
-		pressedCombination = "Ctrl-" + pressedCombination;
+	std::sort(latencies.begin(), latencies.end());
+	Uint32 total = 0;
+	for(Uint32 latency : latencies) {
+		total += latency;
 	}
-
-	return textToControl[pressedCombination];
+	std::cerr << Chthon::format(
+			"Input-to-present latency over {0} frames: avg {1} ms, median {2} ms, 95% {3} ms, max {4} ms",
+			latencies.size(),
+			total / latencies.size(),
+			latencies[latencies.size() / 2],
+			latencies[latencies.size() * 95 / 100],
+			latencies.back()
+			) << std::endl;
 }
 
 int SokobanWidget::exec()
@@ -141,7 +96,7 @@ int SokobanWidget::exec()
 	rect.y = 0;
 	SDL_GetWindowSize(window, &rect.w, &rect.h);
 
-	renderer = SDL_CreateRenderer(window, -1, 0);
+	renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
 	SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
 	SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
 
@@ -151,8 +106,8 @@ int SokobanWidget::exec()
 	settings.levelset = levelSet.getCurrentLevelSet();
 	settings.save();
 
-	Game game = Game(levelSet.getCurrentSokoban(), sprites);
-	Message message = Message(sprites,
+	Game game(levelSet.getCurrentSokoban(), levelSet.getCurrentLevelMap(), sprites);
+	Message message(sprites,
 			levelSet.isOver()
 			? Chthon::format("{0}\nLevels are over.", levelSet.getLevelSetTitle())
 			: Chthon::format(
@@ -165,33 +120,94 @@ int SokobanWidget::exec()
 				)
 			);
 	bool show_message = true;
+#ifdef MINIBAN_PROFILE
+	ProfilerOverlay overlay(sprites);
+	bool show_overlay = false;
+#endif
 
 	SDL_Event event;
 	Uint32 last_time = SDL_GetTicks();
+	bool dirty = true;
 	while(!quit) {
-		if(show_message) {
-			message.paint(renderer, rect);
-		} else {
-			game.paint(renderer, rect);
-		}
+		bool animating = show_message ? message.is_animating() : game.is_animating();
+		if(dirty || animating) {
+#ifdef MINIBAN_PROFILE
+			long long frame_start = Profiler::now();
+			SpriteBatch::resetDrawCallCount();
+#endif
+			if(show_message) {
+				message.paint(renderer, rect);
+			} else {
+				game.paint(renderer, rect);
+			}
+#ifdef MINIBAN_PROFILE
+			if(show_overlay) {
+				overlay.paint(renderer, rect);
+			}
+#endif
 
-		SDL_RenderPresent(renderer);
+			{
+				PROFILE_SCOPE("SDL_RenderPresent");
+				// Frame rate during fades is capped by vsync.
+				SDL_RenderPresent(renderer);
+			}
+			dirty = false;
+			if(measure_latency && input_time != 0) {
+				latencies.push_back(SDL_GetTicks() - input_time);
+				input_time = 0;
+			}
+#ifdef MINIBAN_PROFILE
+			Profiler::frameFinished(Profiler::now() - frame_start, SpriteBatch::getDrawCallCount());
+#endif
+		}
 
-		while(SDL_PollEvent(&event)) {
+		bool has_event = false;
+		if(animating) {
+			has_event = SDL_PollEvent(&event);
+		} else {
+			// Nothing changes until next event, so time spent idle should not be counted.
+			has_event = SDL_WaitEventTimeout(&event, IDLE_WAIT_TIMEOUT);
+			last_time = SDL_GetTicks();
+		}
+		pending_controls.clear();
+		for(; has_event; has_event = SDL_PollEvent(&event)) {
 			if(event.type == SDL_KEYDOWN) {
 				int control = keyToControl(&event.key);
-				if(control == Game::CONTROL_QUIT) {
-					quit = true;
+				// Auto-repeated key is applied at most once per frame, so movement stops as soon as key is released.
+				bool repeated = event.key.repeat && !pending_controls.empty() && pending_controls.back() == control;
+				if(control == Game::CONTROL_NONE || repeated || pending_controls.size() >= MAX_CONTROLS_PER_FRAME) {
+					continue;
 				}
-				if(show_message) {
-					message.processControl(control);
-				} else {
-					game.processControl(control);
+				if(input_time == 0) {
+					input_time = event.key.timestamp;
 				}
+				pending_controls.push_back(control);
+			} else if(event.type == SDL_WINDOWEVENT) {
+				dirty = true;
+			} else if(event.type == SDL_RENDER_TARGETS_RESET) {
+				game.invalidate();
+				message.invalidate();
+				dirty = true;
 			} else if(event.type == SDL_QUIT) {
 				quit = true;
 			}
 		}
+		for(int control : pending_controls) {
+			if(control == Game::CONTROL_QUIT) {
+				quit = true;
+			}
+#ifdef MINIBAN_PROFILE
+			if(control == Game::CONTROL_TOGGLE_OVERLAY) {
+				show_overlay = !show_overlay;
+			}
+#endif
+			if(show_message) {
+				message.processControl(control);
+			} else {
+				game.processControl(control);
+			}
+			dirty = true;
+		}
 
 		Uint32 current_time = SDL_GetTicks();
 		int time_passed = current_time - last_time;
@@ -203,22 +219,37 @@ int SokobanWidget::exec()
 				game.processTime(time_passed);
 			}
 		}
+		// Fade that has just finished still needs its last frame to be shown.
+		if(animating && !(show_message ? message.is_animating() : game.is_animating())) {
+			dirty = true;
+		}
 
 		if(show_message) {
 			if(message.is_done() && !levelSet.isOver()) {
 				if(!levelSet.isOver()) {
 					show_message = false;
+					dirty = true;
 				}
 			}
 		} else {
 			if(game.is_done()) {
+#ifdef MINIBAN_COUNTERS
+				const Sokoban::Counters & counters = game.getSokoban().getCounters();
+				Chthon::log(Chthon::format(
+							"Level {0}: {1} moves, {2} pushes, {3} undos ({4} usec, {5} usec undo), goto {6} times, {7} cells ({8} usec)",
+							levelSet.getCurrentLevelName(),
+							counters.moves, counters.pushes, counters.undos,
+							counters.move_nsec / 1000, counters.undo_nsec / 1000,
+							counters.pathfinding_calls, counters.visited_cells, counters.pathfinding_nsec / 1000
+							));
+#endif
 				settings.level_index = levelSet.getCurrentLevelIndex();
 				settings.levelset = levelSet.getCurrentLevelSet();
 				settings.save();
 
 				levelSet.moveToNextLevel();
 				if(!levelSet.isOver()) {
-					game.load(levelSet.getCurrentSokoban());
+					game.load(levelSet.getCurrentSokoban(), levelSet.getCurrentLevelMap());
 				}
 
 				message.set_text(
@@ -234,10 +265,20 @@ int SokobanWidget::exec()
 							)
 						);
 				show_message = true;
+				dirty = true;
 			}
 		}
 	}
 
+#ifdef MINIBAN_PROFILE
+	const char * trace_file = getenv("MINIBAN_TRACE");
+	if(trace_file) {
+		Profiler::exportChromeTrace(trace_file);
+	}
+#endif
+
+	printLatencyStats();
+
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
@@ -2,6 +2,8 @@
 #include "levelset.h"
 #include "sprites.h"
 #include "settings.h"
+#include "keymap.h"
+#include <vector>
 #include "SDL2/SDL.h"
 class SDL_KeyboardEvent;
 class SDL_Renderer;
@@ -13,6 +15,7 @@ public:
 	int exec();
 protected:
 	int keyToControl(SDL_KeyboardEvent * event);
+	void printLatencyStats();
 private:
 	Settings settings;
 	SDL_Renderer * renderer;
@@ -21,5 +24,10 @@ private:
 	Sprites sprites;
 	bool quit;
 	SDL_Rect rect;
+	Keymap keymap;
+	std::vector<int> pending_controls;
+	bool measure_latency;
+	Uint32 input_time;
+	std::vector<Uint32> latencies;
 };
 
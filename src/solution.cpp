@@ -0,0 +1,173 @@
+#include "solution.h"
+#include "sokoban.h"
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+const char MAGIC[] = { 'M', 'N', 'B', 'S' };
+// Packed steps are read by pieces, so corrupted step count fails at the end of data instead of allocating all of it at once.
+const unsigned READ_CHUNK_SIZE = 64 * 1024;
+const char STEP_CHARS[] = "lrdu";
+
+int encodeStep(char step)
+{
+	switch(step) {
+		case 'l': return Sokoban::LEFT;
+		case 'r': return Sokoban::RIGHT;
+		case 'd': return Sokoban::DOWN;
+		case 'u': return Sokoban::UP;
+		case 'L': return Sokoban::LEFT | Solution::PUSH_FLAG;
+		case 'R': return Sokoban::RIGHT | Solution::PUSH_FLAG;
+		case 'D': return Sokoban::DOWN | Solution::PUSH_FLAG;
+		case 'U': return Sokoban::UP | Solution::PUSH_FLAG;
+		case '-': return Solution::UNDO_FLAG;
+	}
+	throw Solution::InvalidStepException(step);
+}
+
+char decodeStep(int step)
+{
+	if(step & Solution::UNDO_FLAG) {
+		return '-';
+	}
+	char ch = STEP_CHARS[step & 0x3];
+	return (step & Solution::PUSH_FLAG) ? toupper(ch) : ch;
+}
+
+// Every byte decodes into the same pair of chars, so whole bytes are expanded by lookup.
+struct ByteDecodingTable {
+	char chars[256 * 2];
+	ByteDecodingTable()
+	{
+		for(int byte = 0; byte < 256; ++byte) {
+			chars[byte * 2] = decodeStep(byte & 0xf);
+			chars[byte * 2 + 1] = decodeStep(byte >> 4);
+		}
+	}
+};
+
+// Initialization of local static is thread-safe, solutions are verified by several threads at once in tools.
+const char * byteDecodingTable()
+{
+	static const ByteDecodingTable table;
+	return table.chars;
+}
+
+void writeUint32(std::ostream & out, unsigned value)
+{
+	for(int i = 0; i < 4; ++i) {
+		out.put(char((value >> (i * 8)) & 0xff));
+	}
+}
+
+unsigned readUint32(const unsigned char * bytes)
+{
+	return unsigned(bytes[0]) | (unsigned(bytes[1]) << 8) | (unsigned(bytes[2]) << 16) | (unsigned(bytes[3]) << 24);
+}
+
+}
+
+Solution::Solution()
+	: step_count(0)
+{
+}
+
+Solution::Solution(const std::string & history)
+	: step_count(history.size()), packed((history.size() + 1) / 2, 0)
+{
+	for(unsigned i = 0; i < history.size(); ++i) {
+		packed[i / 2] |= encodeStep(history[i]) << ((i % 2) * 4);
+	}
+}
+
+int Solution::stepAt(unsigned index) const
+{
+	return (packed[index / 2] >> ((index % 2) * 4)) & 0xf;
+}
+
+std::string Solution::toString() const
+{
+	const char * table = byteDecodingTable();
+	std::string result(step_count, ' ');
+	unsigned full_bytes = step_count / 2;
+	for(unsigned i = 0; i < full_bytes; ++i) {
+		memcpy(&result[i * 2], table + packed[i] * 2, 2);
+	}
+	if(step_count % 2) {
+		result[step_count - 1] = decodeStep(packed[full_bytes] & 0xf);
+	}
+	return result;
+}
+
+bool Solution::replay(Sokoban & sokoban) const
+{
+	try {
+		for(unsigned i = 0; i < step_count; ++i) {
+			int step = stepAt(i);
+			if(step & UNDO_FLAG) {
+				if(!sokoban.undo()) {
+					return false;
+				}
+				continue;
+			}
+			// Step should be marked as push exactly when it moves a box.
+			int pushes = sokoban.getHistoryPushes();
+			if(!sokoban.movePlayer(step & 0x3)) {
+				return false;
+			}
+			if((sokoban.getHistoryPushes() != pushes) != bool(step & PUSH_FLAG)) {
+				return false;
+			}
+		}
+	} catch(const Sokoban::InvalidUndoException & e) {
+		return false;
+	}
+	return true;
+}
+
+bool Solution::verify(const Sokoban & level) const
+{
+	Sokoban sokoban = level;
+	return replay(sokoban) && sokoban.isSolved();
+}
+
+Solution Solution::load(std::istream & in)
+{
+	unsigned char header[HEADER_SIZE];
+	if(!in.read(reinterpret_cast<char*>(header), HEADER_SIZE)) {
+		throw InvalidFormatException();
+	}
+	if(memcmp(header, MAGIC, sizeof(MAGIC)) != 0 || header[4] != FORMAT_VERSION) {
+		throw InvalidFormatException();
+	}
+	if(header[5] != 0 || header[6] != 0 || header[7] != 0) {
+		throw InvalidFormatException();
+	}
+	Solution result;
+	result.step_count = readUint32(header + 8);
+	unsigned byte_count = result.step_count / 2 + result.step_count % 2;
+	while(result.packed.size() < byte_count) {
+		unsigned offset = result.packed.size();
+		unsigned chunk = std::min(READ_CHUNK_SIZE, byte_count - offset);
+		result.packed.resize(offset + chunk);
+		if(!in.read(reinterpret_cast<char*>(&result.packed[offset]), chunk)) {
+			throw InvalidFormatException();
+		}
+	}
+	return result;
+}
+
+void Solution::save(std::ostream & out) const
+{
+	out.write(MAGIC, sizeof(MAGIC));
+	out.put(char(FORMAT_VERSION));
+	out.put(0).put(0).put(0);
+	writeUint32(out, step_count);
+	if(!packed.empty()) {
+		out.write(reinterpret_cast<const char*>(&packed[0]), packed.size());
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <iosfwd>
+class Sokoban;
+
+// Compact form of LURD history strings.
+// Every step takes one nibble: bits 0-1 are direction (same values as Sokoban::LEFT..UP),
+// bit 2 is push flag, bit 3 marks undo step ('-' in full history tracking).
+// Two steps are packed into a byte, the first one goes to the lower nibble.
+//
+// File layout (all integers are little-endian):
+//   4 bytes  magic "MNBS"
+//   1 byte   format version (1)
+//   3 bytes  reserved, zero
+//   4 bytes  step count
+//   N bytes  packed steps, N = (step count + 1) / 2
+class Solution {
+public:
+	enum { PUSH_FLAG = 0x4, UNDO_FLAG = 0x8 };
+	enum { FORMAT_VERSION = 1, HEADER_SIZE = 12 };
+
+	class InvalidStepException {
+	public:
+		InvalidStepException(char step) : invalidStep(step) {}
+		char invalidStep;
+	};
+	class InvalidFormatException {};
+
+	Solution();
+	explicit Solution(const std::string & history);
+
+	static Solution load(std::istream & in);
+	void save(std::ostream & out) const;
+
+	unsigned size() const { return step_count; }
+	bool empty() const { return step_count == 0; }
+	int stepAt(unsigned index) const;
+	const std::vector<unsigned char> & getPackedSteps() const { return packed; }
+
+	std::string toString() const;
+	bool replay(Sokoban & sokoban) const;
+	bool verify(const Sokoban & level) const;
+private:
+	unsigned step_count;
+	std::vector<unsigned char> packed;
+};
@@ -0,0 +1,509 @@
+#include "solver.h"
+#include "packedstate.h"
+#include "sokoban.h"
+#include <algorithm>
+#include <chrono>
+#include <queue>
+
+namespace {
+
+const char PUSH_CHARS[] = "LRDU";
+const unsigned CHECK_LIMITS_EVERY = 1024;
+
+// Node index is the same as index of its state in StateArena.
+struct Node {
+	int parent;
+	// Push that led to this node: cell of the box before push and direction.
+	// For goal room macro box_to is the goal, otherwise it is the next cell in direction.
+	int box_from, direction, box_to;
+	int pushes;
+};
+
+struct QueueEntry {
+	int cost, estimate, node;
+	bool operator<(const QueueEntry & other) const
+	{
+		// Lower cost first, then the one that is closer to goals.
+		if(cost != other.cost) {
+			return cost > other.cost;
+		}
+		return estimate > other.estimate;
+	}
+};
+
+// Cells reachable by player without pushing, marked with the current stamp.
+class Reachability {
+public:
+	Reachability(const LevelMap & level_map)
+		: map(level_map), marks(level_map.getCellCount(), 0), stamp(0)
+	{
+	}
+	// Returns the smallest reachable index, so all player positions in one area give the same state.
+	int fill(int player, const std::vector<char> & occupied)
+	{
+		++stamp;
+		queue.clear();
+		queue.push_back(player);
+		marks[player] = stamp;
+		int result = player;
+		for(unsigned i = 0; i < queue.size(); ++i) {
+			int cell = queue[i];
+			result = std::min(result, cell);
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int next = map.getNeighbour(cell, direction);
+				if(next != LevelMap::NO_CELL && !occupied[next] && marks[next] != stamp) {
+					marks[next] = stamp;
+					queue.push_back(next);
+				}
+			}
+		}
+		return result;
+	}
+	bool isReachable(int cell) const { return marks[cell] == stamp; }
+private:
+	const LevelMap & map;
+	std::vector<unsigned> marks;
+	unsigned stamp;
+	std::vector<int> queue;
+};
+
+// Corral is an area that player cannot reach, closed by walls and boxes (barrier).
+// PI-corral is the one where every possible push of barrier boxes goes into the corral (I)
+// and player can make all those pushes right now (P). If such corral still has something to solve,
+// its barrier has to be pushed sooner or later anyway, so other pushes can be skipped in this node.
+class CorralPruning {
+public:
+	// Goals and distances are the ones of the search, they may differ from the map's own.
+	CorralPruning(const LevelMap & level_map, const std::vector<char> & goals, const std::vector<int> & distances)
+		: map(level_map), goal_flags(goals), goal_distances(distances), marks(level_map.getCellCount(), 0), allowed(level_map.getCellCount(), 0), stamp(0), allowed_stamp(0)
+	{
+	}
+	// Returns false if some PI-corral is not solved and has nothing to push, i.e. position is lost.
+	// Otherwise restricted is set when pushes should be limited to boxes for which isAllowed() is true.
+	bool find(const std::vector<char> & occupied, const Reachability & reachability, bool & restricted)
+	{
+		restricted = false;
+		int best_pushes = -1;
+		unsigned first_corral = stamp + 1;
+		for(int start = 0; start < map.getCellCount(); ++start) {
+			if(occupied[start] || reachability.isReachable(start) || marks[start] >= first_corral) {
+				continue;
+			}
+			// Corral cells and its barrier boxes get the same mark, boxes that player cannot touch are inside.
+			unsigned corral = ++stamp;
+			bool unsolved = false;
+			queue.assign(1, start);
+			barrier.clear();
+			marks[start] = corral;
+			for(unsigned i = 0; i < queue.size(); ++i) {
+				int cell = queue[i];
+				unsolved = unsolved || bool(goal_flags[cell]) != bool(occupied[cell]);
+				for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+					int next = map.getNeighbour(cell, direction);
+					if(next == LevelMap::NO_CELL || marks[next] == corral || reachability.isReachable(next)) {
+						continue;
+					}
+					marks[next] = corral;
+					if(occupied[next] && isBarrier(next, reachability)) {
+						barrier.push_back(next);
+						unsolved = unsolved || !goal_flags[next];
+					} else {
+						queue.push_back(next);
+					}
+				}
+			}
+			int pushes = countPushes(corral, occupied, reachability);
+			if(pushes < 0 || !unsolved) {
+				continue;
+			}
+			if(pushes == 0) {
+				return false;
+			}
+			if(best_pushes < 0 || pushes < best_pushes) {
+				best_pushes = pushes;
+				best_barrier = barrier;
+			}
+		}
+		if(best_pushes > 0) {
+			restricted = true;
+			++allowed_stamp;
+			for(int box : best_barrier) {
+				allowed[box] = allowed_stamp;
+			}
+		}
+		return true;
+	}
+	bool isAllowed(int box) const { return allowed[box] == allowed_stamp; }
+private:
+	const LevelMap & map;
+	const std::vector<char> & goal_flags;
+	const std::vector<int> & goal_distances;
+	std::vector<unsigned> marks, allowed;
+	unsigned stamp, allowed_stamp;
+	std::vector<int> queue, barrier, best_barrier;
+
+	bool isBarrier(int box, const Reachability & reachability) const
+	{
+		for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+			int next = map.getNeighbour(box, direction);
+			if(next != LevelMap::NO_CELL && reachability.isReachable(next)) {
+				return true;
+			}
+		}
+		return false;
+	}
+	// Number of pushes into the corral, or -1 if it is not a PI-corral.
+	int countPushes(unsigned corral, const std::vector<char> & occupied, const Reachability & reachability) const
+	{
+		int pushes = 0;
+		for(int box : barrier) {
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int behind = map.getNeighbour(box, LevelMap::opposite(direction));
+				int target = map.getNeighbour(box, direction);
+				// Pushes from inside or from behind another barrier box need the corral to be opened first.
+				if(behind == LevelMap::NO_CELL || target == LevelMap::NO_CELL || marks[behind] == corral) {
+					continue;
+				}
+				if(marks[target] != corral) {
+					// Push out of the corral, now or after the cell behind is opened (box moved away, other corral entered),
+					// unless box would be lost there.
+					if(goal_distances[target] >= 0) {
+						return -1;
+					}
+					continue;
+				}
+				if(occupied[target] || goal_distances[target] < 0) {
+					continue;
+				}
+				if(!reachability.isReachable(behind)) {
+					return -1;
+				}
+				++pushes;
+			}
+		}
+		return pushes;
+	}
+};
+
+}
+
+Solver::Solver(const Sokoban & sokoban, const Options & solver_options)
+	: own_map(sokoban), map(own_map), options(solver_options),
+	start_boxes(map.getBoxIndices(sokoban)), start_player(map.getPlayerIndex(sokoban)),
+	goals(map.getGoals())
+{
+	if(options.goal_room_macros) {
+		own_map.findGoalRooms(start_player, start_boxes);
+	}
+	init();
+}
+
+Solver::Solver(const LevelMap & level_map, const std::vector<int> & boxes, int player, const std::vector<int> & target_goals, const Options & solver_options)
+	: map(level_map), options(solver_options),
+	start_boxes(boxes), start_player(player),
+	goals(target_goals)
+{
+	std::sort(start_boxes.begin(), start_boxes.end());
+	std::sort(goals.begin(), goals.end());
+	if(goals != map.getGoals()) {
+		options.goal_room_macros = false;
+	}
+	init();
+}
+
+void Solver::init()
+{
+	goal_flags.assign(map.getCellCount(), 0);
+	for(int goal : goals) {
+		goal_flags[goal] = 1;
+	}
+	if(goals == map.getGoals()) {
+		goal_distances.resize(map.getCellCount());
+		for(int cell = 0; cell < map.getCellCount(); ++cell) {
+			goal_distances[cell] = map.getGoalDistance(cell);
+		}
+	} else {
+		goal_distances = map.calculateGoalDistances(goals);
+	}
+	entrance_rooms.assign(map.getCellCount(), -1);
+	if(!options.goal_room_macros) {
+		return;
+	}
+	const std::vector<LevelMap::GoalRoom> & rooms = map.getGoalRooms();
+	for(unsigned i = 0; i < rooms.size(); ++i) {
+		if(!rooms[i].packing_order.empty()) {
+			entrance_rooms[rooms[i].entrance] = i;
+		}
+	}
+}
+
+// Next goal of the room to fill, if the room is filled exactly by a prefix of its packing order.
+// Otherwise boxes were pushed in without macro and order is broken, so NO_CELL is returned.
+int Solver::getMacroGoal(int entrance, const std::vector<char> & occupied) const
+{
+	int room = entrance_rooms[entrance];
+	if(room < 0) {
+		return LevelMap::NO_CELL;
+	}
+	const LevelMap::GoalRoom & goal_room = map.getGoalRooms()[room];
+	unsigned filled = 0;
+	while(filled < goal_room.packing_order.size() && occupied[goal_room.packing_order[filled]]) {
+		++filled;
+	}
+	if(filled == goal_room.packing_order.size()) {
+		return LevelMap::NO_CELL;
+	}
+	for(int cell : goal_room.cells) {
+		if(occupied[cell] && std::find(goal_room.packing_order.begin(), goal_room.packing_order.begin() + filled, cell) == goal_room.packing_order.begin() + filled) {
+			return LevelMap::NO_CELL;
+		}
+	}
+	return goal_room.packing_order[filled];
+}
+
+const char * Solver::getStatusName(Status status)
+{
+	switch(status) {
+		case SOLVED: return "solved";
+		case UNSOLVABLE: return "unsolvable";
+		case TIMEOUT: return "timeout";
+		case OUT_OF_MEMORY: return "out_of_memory";
+		case CANCELLED: return "cancelled";
+		case TOO_LARGE: return "too_large";
+	}
+	return "unknown";
+}
+
+// Macros and pruning skip positions, so search that runs out of nodes with them proves nothing:
+// it is repeated without them within what is left of limits, and only that one can report UNSOLVABLE.
+Solver::Result Solver::solve(const Limits & limits, const std::atomic<bool> * cancel) const
+{
+	Result result = search(limits, cancel, options);
+	bool pruned = options.goal_room_macros || options.tunnel_macros || options.pi_corrals;
+	if(result.status != UNSOLVABLE || result.nodes == 0 || !pruned) {
+		return result;
+	}
+	Limits rest = limits;
+	if(limits.seconds > 0) {
+		rest.seconds = limits.seconds - result.seconds;
+	}
+	if(limits.nodes > 0) {
+		rest.nodes = (limits.nodes > result.nodes) ? limits.nodes - result.nodes : 0;
+	}
+	if((limits.seconds > 0 && rest.seconds <= 0) || (limits.nodes > 0 && rest.nodes == 0)) {
+		result.status = TIMEOUT;
+		return result;
+	}
+	Result complete = search(rest, cancel, Options(false));
+	complete.nodes += result.nodes;
+	complete.seconds += result.seconds;
+	complete.peak_memory_bytes = std::max(complete.peak_memory_bytes, result.peak_memory_bytes);
+	return complete;
+}
+
+Solver::Result Solver::search(const Limits & limits, const std::atomic<bool> * cancel, const Options & search_options) const
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start_time = Clock::now();
+	Result result;
+	if(start_boxes.size() != goals.size()) {
+		return result;
+	}
+	for(int box : start_boxes) {
+		if(goal_distances[box] < 0) {
+			return result;
+		}
+	}
+
+	// Cell indices of larger levels do not fit into packed states.
+	if(!PackedState::canPack(map)) {
+		result.status = TOO_LARGE;
+		return result;
+	}
+
+	std::vector<Node> nodes;
+	StateArena visited(PackedState::getSize(start_boxes.size()));
+	std::priority_queue<QueueEntry> queue;
+	std::vector<char> occupied(map.getCellCount(), 0);
+	Reachability reachability(map);
+	// Reachability of the parent is still needed for its other pushes, so children use their own.
+	Reachability child_reachability(map);
+	CorralPruning corrals(map, goal_flags, goal_distances);
+	auto memoryUsed = [&]() {
+		return nodes.capacity() * sizeof(Node) + visited.getMemoryBytes() + queue.size() * sizeof(QueueEntry);
+	};
+
+	std::vector<int> boxes = start_boxes;
+	int player = start_player;
+	std::vector<uint16_t> state(visited.getStateSize());
+	// State buffer holds sorted boxes and normalized player of the new node.
+	auto addNode = [&](int parent, int box_from, int direction, int box_to, int pushes) {
+		bool added = false;
+		visited.insert(&state[0], added);
+		if(!added) {
+			return;
+		}
+		int estimate = 0;
+		for(unsigned i = 0; i + 1 < state.size(); ++i) {
+			estimate += goal_distances[state[i]];
+		}
+		Node node = { parent, box_from, direction, box_to, pushes };
+		nodes.push_back(node);
+		QueueEntry entry = { pushes + estimate, estimate, int(nodes.size()) - 1 };
+		queue.push(entry);
+	};
+	for(int box : boxes) {
+		occupied[box] = 1;
+	}
+	std::copy(boxes.begin(), boxes.end(), state.begin());
+	state.back() = reachability.fill(player, occupied);
+	addNode(-1, -1, -1, -1, 0);
+	for(int box : boxes) {
+		occupied[box] = 0;
+	}
+
+	int solved_node = -1;
+	unsigned expanded = 0;
+	size_t peak_memory = 0;
+	while(!queue.empty()) {
+		QueueEntry entry = queue.top();
+		queue.pop();
+		if(entry.estimate == 0) {
+			solved_node = entry.node;
+			break;
+		}
+		if(limits.nodes > 0 && nodes.size() > limits.nodes) {
+			result.status = TIMEOUT;
+			break;
+		}
+		if(expanded++ % CHECK_LIMITS_EVERY == 0) {
+			double seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+			peak_memory = std::max(peak_memory, memoryUsed());
+			if(cancel && *cancel) {
+				result.status = CANCELLED;
+				break;
+			}
+			if(limits.seconds > 0 && seconds > limits.seconds) {
+				result.status = TIMEOUT;
+				break;
+			}
+			if(limits.memory_bytes > 0 && peak_memory > limits.memory_bytes) {
+				result.status = OUT_OF_MEMORY;
+				break;
+			}
+		}
+
+		int node_index = entry.node;
+		const uint16_t * node_state = visited.get(node_index);
+		boxes.assign(node_state, node_state + boxes.size());
+		player = node_state[boxes.size()];
+		for(int box : boxes) {
+			occupied[box] = 1;
+		}
+		reachability.fill(player, occupied);
+		bool restricted = false;
+		if(search_options.pi_corrals && !corrals.find(occupied, reachability, restricted)) {
+			for(int box : boxes) {
+				occupied[box] = 0;
+			}
+			continue;
+		}
+		for(unsigned i = 0; i < boxes.size(); ++i) {
+			int box = boxes[i];
+			if(restricted && !corrals.isAllowed(box)) {
+				continue;
+			}
+			for(int direction = Sokoban::LEFT; direction <= Sokoban::UP; ++direction) {
+				int behind = map.getNeighbour(box, LevelMap::opposite(direction));
+				int target = map.getNeighbour(box, direction);
+				if(behind == LevelMap::NO_CELL || target == LevelMap::NO_CELL) {
+					continue;
+				}
+				if(!reachability.isReachable(behind) || occupied[target] || goal_distances[target] < 0) {
+					continue;
+				}
+				int pushes = nodes[node_index].pushes + 1;
+				int new_player = box;
+				occupied[box] = 0;
+				int goal = (search_options.goal_room_macros && map.getGoalRoom(box) < 0) ? getMacroGoal(target, occupied) : int(LevelMap::NO_CELL);
+				int macro_pushes = -1;
+				if(goal != LevelMap::NO_CELL) {
+					int macro_player = LevelMap::NO_CELL;
+					macro_pushes = map.pushBox(occupied, box, target, goal, macro_player);
+					if(macro_pushes >= 0) {
+						target = goal;
+						pushes += macro_pushes;
+						new_player = macro_player;
+					}
+				}
+				// Player in a corridor behind the box cannot get around it, so box goes on until it leaves the corridor.
+				while(macro_pushes < 0 && search_options.tunnel_macros && map.isTunnel(new_player, direction) && map.isArticulation(new_player)
+						&& map.isTunnel(target, direction) && !goal_flags[target]) {
+					int next = map.getNeighbour(target, direction);
+					if(next == LevelMap::NO_CELL || occupied[next] || goal_distances[next] < 0) {
+						break;
+					}
+					new_player = target;
+					target = next;
+					++pushes;
+				}
+				occupied[box] = 1;
+				// Only the moved box is out of order, so it is shifted into place instead of sorting.
+				std::copy(boxes.begin(), boxes.end(), state.begin());
+				unsigned pos = i;
+				for(; pos > 0 && state[pos - 1] > target; --pos) {
+					state[pos] = state[pos - 1];
+				}
+				for(; pos + 1 < boxes.size() && state[pos + 1] < target; ++pos) {
+					state[pos] = state[pos + 1];
+				}
+				state[pos] = target;
+				occupied[box] = 0;
+				occupied[target] = 1;
+				state.back() = child_reachability.fill(new_player, occupied);
+				occupied[target] = 0;
+				occupied[box] = 1;
+				addNode(node_index, box, direction, target, pushes);
+			}
+		}
+		for(int box : boxes) {
+			occupied[box] = 0;
+		}
+	}
+
+	result.nodes = nodes.size();
+	result.peak_memory_bytes = std::max(peak_memory, memoryUsed());
+	if(solved_node >= 0) {
+		result.status = SOLVED;
+		std::vector<int> path;
+		for(int node = solved_node; nodes[node].parent >= 0; node = nodes[node].parent) {
+			path.push_back(node);
+		}
+		std::reverse(path.begin(), path.end());
+		for(int box : start_boxes) {
+			occupied[box] = 1;
+		}
+		player = start_player;
+		for(int node : path) {
+			int box = nodes[node].box_from;
+			int direction = nodes[node].direction;
+			std::string walk;
+			map.findPath(occupied, player, map.getNeighbour(box, LevelMap::opposite(direction)), walk);
+			result.solution += walk;
+			result.solution += PUSH_CHARS[direction];
+			occupied[box] = 0;
+			player = box;
+			int target = map.getNeighbour(box, direction);
+			if(nodes[node].box_to != target) {
+				std::string macro;
+				map.pushBox(occupied, player, target, nodes[node].box_to, player, &macro);
+				result.solution += macro;
+			}
+			occupied[nodes[node].box_to] = 1;
+		}
+		result.moves = result.solution.size();
+		result.pushes = nodes[solved_node].pushes;
+	}
+	result.seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+	return result;
+}
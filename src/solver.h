@@ -0,0 +1,82 @@
+#pragma once
+#include "levelmap.h"
+#include <atomic>
+#include <string>
+#include <vector>
+class Sokoban;
+
+// A* search over box pushes, starting from the current position of the level.
+// Heuristic is the sum of push distances of boxes to their nearest goals,
+// states with the same boxes and player area are the same node.
+// Solutions are close to minimal in pushes, but it is not guaranteed.
+// Box that is pushed to the entrance of a goal room goes on to its goal in the same node (see LevelMap::GoalRoom),
+// box in a tunnel is pushed through it, and pushes that do not open a PI-corral are pruned.
+class Solver {
+public:
+	// TOO_LARGE is for levels whose cells do not fit into packed states, search is not started for them.
+	enum Status { SOLVED, UNSOLVABLE, TIMEOUT, OUT_OF_MEMORY, CANCELLED, TOO_LARGE };
+
+	struct Limits {
+		// Zero means no limit.
+		double seconds;
+		size_t memory_bytes;
+		// Unlike time, gives the same result on any machine. Hitting it is reported as TIMEOUT.
+		unsigned nodes;
+		Limits() : seconds(0), memory_bytes(0), nodes(0) {}
+	};
+
+	struct Options {
+		// Pushing box into a goal room is one macro step to the next goal of packing order.
+		// Room then cannot be used to park boxes, so rare levels are solved only by the repeated search (see solve()).
+		bool goal_room_macros;
+		// Box pushed along a one-wide corridor by the player who cannot get around it goes through in one step.
+		bool tunnel_macros;
+		// When player is locked out of an area that can be opened only by pushing its boxes inwards,
+		// only those pushes are tried (see CorralPruning in solver.cpp).
+		bool pi_corrals;
+		// All enhancements are on or off.
+		explicit Options(bool enabled = true) : goal_room_macros(enabled), tunnel_macros(enabled), pi_corrals(enabled) {}
+	};
+
+	struct Result {
+		Status status;
+		// LURD string, the same as Sokoban::historyAsString().
+		std::string solution;
+		unsigned nodes;
+		double seconds;
+		// Size of search data: nodes, packed states with their hash table and queue.
+		size_t peak_memory_bytes;
+		int moves, pushes;
+		Result() : status(UNSOLVABLE), nodes(0), seconds(0), peak_memory_bytes(0), moves(0), pushes(0) {}
+	};
+
+	explicit Solver(const Sokoban & sokoban, const Options & options = Options());
+	// Searches on existing map, which should outlive the solver, from given cells to any goals, e.g. other than the map's ones.
+	// Goal room macros are used only with the map's own goals and rooms that were found on it (see LevelMap::findGoalRooms).
+	Solver(const LevelMap & level_map, const std::vector<int> & boxes, int player, const std::vector<int> & goals, const Options & options = Options());
+
+	// Search can be stopped from other thread by setting cancel flag.
+	// UNSOLVABLE is reported only after search without macros and pruning, which is repeated when the first one runs out of nodes.
+	Result solve(const Limits & limits, const std::atomic<bool> * cancel = 0) const;
+	const LevelMap & getLevelMap() const { return map; }
+
+	static const char * getStatusName(Status status);
+private:
+	LevelMap own_map;
+	const LevelMap & map;
+	Options options;
+	std::vector<int> start_boxes;
+	int start_player;
+	std::vector<int> goals;
+	std::vector<char> goal_flags;
+	// Push distance to the nearest goal, -1 for dead cells.
+	std::vector<int> goal_distances;
+	// Room index for every cell that is an entrance of a room with packing order, -1 for other cells.
+	std::vector<int> entrance_rooms;
+
+	Solver(const Solver &) = delete;
+	Solver & operator=(const Solver &) = delete;
+	void init();
+	Result search(const Limits & limits, const std::atomic<bool> * cancel, const Options & search_options) const;
+	int getMacroGoal(int entrance, const std::vector<char> & occupied) const;
+};
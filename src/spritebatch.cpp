@@ -0,0 +1,123 @@
+#include "spritebatch.h"
+#include <SDL2/SDL.h>
+
+namespace {
+
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+bool geometryEnabled = true;
+#else
+bool geometryEnabled = false;
+#endif
+int drawCallCount = 0;
+
+}
+
+void SpriteBatch::setGeometryEnabled(bool enabled)
+{
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	geometryEnabled = enabled;
+#endif
+}
+
+int SpriteBatch::getDrawCallCount()
+{
+	return drawCallCount;
+}
+
+void SpriteBatch::resetDrawCallCount()
+{
+	drawCallCount = 0;
+}
+
+SpriteBatch::SpriteBatch()
+	: renderer(0), texture(0), texture_width(1), texture_height(1)
+{
+	color.x = color.y = color.u = color.v = 0;
+	color.r = color.g = color.b = color.a = 255;
+}
+
+void SpriteBatch::begin(SDL_Renderer * painter)
+{
+	renderer = painter;
+	texture = 0;
+	vertices.clear();
+	indices.clear();
+	src_rects.clear();
+	dest_rects.clear();
+}
+
+void SpriteBatch::add(SDL_Texture * quad_texture, const SDL_Rect & src_rect, const SDL_Rect & dest_rect)
+{
+	if(quad_texture != texture) {
+		flush();
+		texture = quad_texture;
+		int w = 1, h = 1;
+		SDL_QueryTexture(texture, 0, 0, &w, &h);
+		texture_width = w;
+		texture_height = h;
+		color.a = 255;
+		if(SDL_GetTextureColorMod(texture, &color.r, &color.g, &color.b) != 0) {
+			color.r = color.g = color.b = 255;
+		}
+	}
+	if(!geometryEnabled) {
+		const Rect src = { src_rect.x, src_rect.y, src_rect.w, src_rect.h };
+		const Rect dest = { dest_rect.x, dest_rect.y, dest_rect.w, dest_rect.h };
+		src_rects.push_back(src);
+		dest_rects.push_back(dest);
+		return;
+	}
+
+	float left = src_rect.x / texture_width;
+	float top = src_rect.y / texture_height;
+	float right = (src_rect.x + src_rect.w) / texture_width;
+	float bottom = (src_rect.y + src_rect.h) / texture_height;
+	int base = vertices.size();
+	const float xs[4] = { float(dest_rect.x), float(dest_rect.x + dest_rect.w), float(dest_rect.x + dest_rect.w), float(dest_rect.x) };
+	const float ys[4] = { float(dest_rect.y), float(dest_rect.y), float(dest_rect.y + dest_rect.h), float(dest_rect.y + dest_rect.h) };
+	const float us[4] = { left, right, right, left };
+	const float vs[4] = { top, top, bottom, bottom };
+	for(int i = 0; i < 4; ++i) {
+		Vertex corner = color;
+		corner.x = xs[i];
+		corner.y = ys[i];
+		corner.u = us[i];
+		corner.v = vs[i];
+		vertices.push_back(corner);
+	}
+	int quad_indices[6] = { base, base + 1, base + 2, base, base + 2, base + 3 };
+	indices.insert(indices.end(), quad_indices, quad_indices + 6);
+}
+
+void SpriteBatch::flush()
+{
+	if(!renderer) {
+		return;
+	}
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+	static_assert(sizeof(Vertex) == sizeof(SDL_Vertex), "Vertex should have the same layout as SDL_Vertex");
+	if(!vertices.empty()) {
+		SDL_RenderGeometry(renderer, texture, reinterpret_cast<const SDL_Vertex *>(&vertices[0]), vertices.size(), &indices[0], indices.size());
+		++drawCallCount;
+	}
+#endif
+	for(unsigned i = 0; i < src_rects.size(); ++i) {
+		const Rect & src = src_rects[i];
+		const Rect & dest = dest_rects[i];
+		const SDL_Rect src_rect = { src.x, src.y, src.w, src.h };
+		const SDL_Rect dest_rect = { dest.x, dest.y, dest.w, dest.h };
+		SDL_RenderCopy(renderer, texture, &src_rect, &dest_rect);
+		++drawCallCount;
+	}
+	vertices.clear();
+	indices.clear();
+	src_rects.clear();
+	dest_rects.clear();
+}
+
+void SpriteBatch::end()
+{
+	flush();
+	renderer = 0;
+	texture = 0;
+}
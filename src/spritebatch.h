@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+class SDL_Renderer;
+class SDL_Texture;
+class SDL_Rect;
+
+// Collects textured quads and submits all quads of the same texture with a single geometry call.
+// Color modulation of texture is taken when texture is switched, so it should not change until flush().
+class SpriteBatch {
+public:
+	SpriteBatch();
+
+	void begin(SDL_Renderer * painter);
+	void add(SDL_Texture * texture, const SDL_Rect & src_rect, const SDL_Rect & dest_rect);
+	void flush();
+	void end();
+
+	static void setGeometryEnabled(bool enabled);
+	static int getDrawCallCount();
+	static void resetDrawCallCount();
+private:
+	// Same layout as SDL_Vertex, which exists only since SDL 2.0.18.
+	struct Vertex {
+		float x, y;
+		unsigned char r, g, b, a;
+		float u, v;
+	};
+	// Copy of SDL_Rect, which is only forward-declared here.
+	struct Rect {
+		int x, y, w, h;
+	};
+
+	SDL_Renderer * renderer;
+	SDL_Texture * texture;
+	float texture_width, texture_height;
+	Vertex color;
+	std::vector<Vertex> vertices;
+	std::vector<int> indices;
+	std::vector<Rect> src_rects, dest_rects;
+};
@@ -1,57 +1,56 @@
 #include "sprites.h"
 #include "sokoban.h"
-#include <chthon2/pixmap.h>
 #include <chthon2/util.h>
 #include <SDL2/SDL.h>
-#include <iostream>
+#include <algorithm>
+#include <cstring>
 
 namespace Sprite {
-#include "../res/sokoban.xpm"
-#include "../res/font.xpm"
-SDL_Texture * load(SDL_Renderer * renderer, const char ** xpm, int size);
+// Pixel arrays are baked from res/*.xpm at build time.
+#include "../tmp/res/sokoban_pixels.h"
+#include "../tmp/res/font_pixels.h"
+SDL_Texture * load(SDL_Renderer * renderer, const unsigned int * pixels, int width, int height);
+void scale(const unsigned int * pixels, int width, int height, int factor, std::vector<unsigned int> & result);
 }
 
-SDL_Texture * Sprite::load(SDL_Renderer * renderer, const char ** xpm, int size)
+SDL_Texture * Sprite::load(SDL_Renderer * renderer, const unsigned int * pixels, int width, int height)
 {
-	SDL_Texture * result = 0;
-	try {
-		std::vector<std::string> xpm_lines(xpm, xpm + size);
-		Chthon::Pixmap pixmap;
-		pixmap.load(xpm_lines);
-		SDL_Surface * surface = SDL_CreateRGBSurface(SDL_SWSURFACE,
-				pixmap.pixels.width(), pixmap.pixels.height(), 32,
-				0x00ff0000,
-				0x0000ff00,
-				0x000000ff,
-				0xff000000
-				);
-		if(SDL_MUSTLOCK(surface)) {
-			SDL_LockSurface(surface);
-		}
-		for(unsigned x = 0; x < pixmap.pixels.width(); ++x) {
-			for(unsigned y = 0; y < pixmap.pixels.height(); ++y) {
-				Uint8 * pixel = (Uint8*)surface->pixels;
-				pixel += (y * surface->pitch) + (x * sizeof(Uint32));
-				Uint32 c = pixmap.palette[(pixmap.pixels.cell(x, y))];
-				*((Uint32*)pixel) = c;
-			}
-		}
-		if(SDL_MUSTLOCK(surface)) {
-			SDL_UnlockSurface(surface);
-		}
-		result = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, pixmap.pixels.width(), pixmap.pixels.height());
-		SDL_UpdateTexture(result, 0, surface->pixels, surface->pitch);
+	SDL_Texture * result = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, width, height);
+	if(result) {
+		SDL_UpdateTexture(result, 0, pixels, width * sizeof(Uint32));
 		SDL_SetTextureBlendMode(result, SDL_BLENDMODE_BLEND);
-	} catch(const Chthon::Pixmap::Exception & e) {
-		std::cerr << e.what << std::endl;
 	}
 	return result;
 }
 
-void Sprites::init(SDL_Renderer * renderer)
+void Sprite::scale(const unsigned int * pixels, int width, int height, int factor, std::vector<unsigned int> & result)
+{
+	// Every row is expanded once and then copied, both loops are plain fills that compiler vectorizes.
+	int scaled_width = width * factor;
+	result.resize(scaled_width * height * factor);
+	unsigned int * dest = result.empty() ? 0 : &result[0];
+	for(int y = 0; y < height; ++y) {
+		const unsigned int * src_row = pixels + y * width;
+		unsigned int * dest_row = dest;
+		for(int x = 0; x < width; ++x) {
+			std::fill_n(dest_row + x * factor, factor, src_row[x]);
+		}
+		dest += scaled_width;
+		for(int i = 1; i < factor; ++i) {
+			memcpy(dest, dest_row, scaled_width * sizeof(unsigned int));
+			dest += scaled_width;
+		}
+	}
+}
+
+void Sprites::init(SDL_Renderer * painter)
 {
-	tileset = Sprite::load(renderer, Sprite::sokoban, Chthon::size_of_array(Sprite::sokoban));
-	font = Sprite::load(renderer, Sprite::font, Chthon::size_of_array(Sprite::font));
+	renderer = painter;
+	tileset_pixels = Sprite::sokoban_pixels;
+	tileset_width = Sprite::sokoban_width;
+	tileset_height = Sprite::sokoban_height;
+	tileset = Sprite::load(renderer, Sprite::sokoban_pixels, Sprite::sokoban_width, Sprite::sokoban_height);
+	font = Sprite::load(renderer, Sprite::font_pixels, Sprite::font_width, Sprite::font_height);
 	
 	cachedSprites[Sprites::FLOOR]           << Chthon::Point(0, 0) << Chthon::Point(1, 0) << Chthon::Point(2, 0) << Chthon::Point(3, 0);
 	cachedSprites[Sprites::WALL]            << Chthon::Point(0, 1) << Chthon::Point(1, 1) << Chthon::Point(2, 1) << Chthon::Point(3, 1);
@@ -69,10 +68,8 @@ void Sprites::init(SDL_Renderer * renderer)
 			max_y = std::max(point.y, max_y);
 		}
 	}
-	int w, h;
-	SDL_QueryTexture(tileset, 0, 0, &w, &h);
-	sprite_width = w / (max_x + 1);
-	sprite_height = h / (max_y + 1);
+	sprite_width = tileset_width / (max_x + 1);
+	sprite_height = tileset_height / (max_y + 1);
 }
 
 SDL_Rect Sprites::getSpritesBounds() const
@@ -120,6 +117,36 @@ SDL_Texture * Sprites::getTileSet() const
 	return tileset;
 }
 
+SDL_Rect Sprites::getSpriteRect(int tileType, int spriteIndex, int scale) const
+{
+	SDL_Rect result = getSpriteRect(tileType, spriteIndex);
+	result.x *= scale;
+	result.y *= scale;
+	result.w *= scale;
+	result.h *= scale;
+	return result;
+}
+
+SDL_Texture * Sprites::getScaledTileSet(int scale) const
+{
+	if(scale <= 1 || tileset == 0) {
+		return tileset;
+	}
+	std::map<int, SDL_Texture *>::const_iterator found = scaledAtlases.find(scale);
+	if(found != scaledAtlases.end()) {
+		return found->second;
+	}
+
+	std::vector<unsigned int> pixels;
+	Sprite::scale(tileset_pixels, tileset_width, tileset_height, scale, pixels);
+	SDL_Texture * texture = Sprite::load(renderer, &pixels[0], tileset_width * scale, tileset_height * scale);
+	if(texture == 0) {
+		return 0;
+	}
+	scaledAtlases[scale] = texture;
+	return texture;
+}
+
 bool Sprites::contains(int tileType) const
 {
 	if(tileset == 0) {
@@ -8,19 +8,26 @@ class SDL_Rect;
 
 class Sprites {
 public:
-	Sprites() : tileset(0), font(0) {}
+	Sprites() : renderer(0), tileset(0), font(0), tileset_pixels(0) {}
 
 	enum { FLOOR, WALL, EMPTY_SLOT, SPACE, PLAYER_ON_FLOOR, PLAYER_ON_SLOT, BOX_ON_FLOOR, BOX_ON_SLOT, CURSOR };
 	void init(SDL_Renderer * renderer);
 	SDL_Rect getSpriteRect(int tileType, int tileIndex) const;
 	SDL_Texture * getTileSet() const;
+	SDL_Rect getSpriteRect(int tileType, int tileIndex, int scale) const;
+	SDL_Texture * getScaledTileSet(int scale) const;
 	SDL_Rect getCharRect(char ch) const;
 	SDL_Texture * getFont() const;
 	SDL_Rect getSpritesBounds() const;
 	bool contains(int tileType) const;
 private:
+	SDL_Renderer * renderer;
 	SDL_Texture * tileset;
 	SDL_Texture * font;
+	const unsigned int * tileset_pixels;
+	int tileset_width, tileset_height;
 	int sprite_width, sprite_height;
 	std::map<int, std::vector<Chthon::Point> > cachedSprites;
+	// Atlases of all scales that fit on screen take a few megabytes, so they are kept until exit.
+	mutable std::map<int, SDL_Texture *> scaledAtlases;
 };
@@ -0,0 +1,230 @@
+#include "textcache.h"
+#include "sprites.h"
+#include <SDL2/SDL.h>
+
+namespace {
+
+const unsigned MAX_CACHED_TEXTS = 32;
+
+SDL_Texture * createTargetTexture(SDL_Renderer * painter, int width, int height)
+{
+	if(width <= 0 || height <= 0) {
+		return 0;
+	}
+	SDL_Texture * result = SDL_CreateTexture(painter, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+	if(result) {
+		SDL_SetTextureBlendMode(result, SDL_BLENDMODE_BLEND);
+	}
+	return result;
+}
+
+// Draw state is shared by the whole renderer, so it is restored after rendering into texture.
+class TargetGuard {
+public:
+	TargetGuard(SDL_Renderer * painter, SDL_Texture * target)
+		: renderer(painter), old_target(SDL_GetRenderTarget(painter))
+	{
+		SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+		SDL_GetRenderDrawBlendMode(renderer, &blend_mode);
+		ok = SDL_SetRenderTarget(renderer, target) == 0;
+	}
+	~TargetGuard()
+	{
+		SDL_SetRenderTarget(renderer, old_target);
+		SDL_SetRenderDrawColor(renderer, r, g, b, a);
+		SDL_SetRenderDrawBlendMode(renderer, blend_mode);
+	}
+	bool ok;
+private:
+	SDL_Renderer * renderer;
+	SDL_Texture * old_target;
+	Uint8 r, g, b, a;
+	SDL_BlendMode blend_mode;
+};
+
+}
+
+TextCache::TextCache(const Sprites & _sprites)
+	: sprites(_sprites)
+{
+}
+
+TextCache::~TextCache()
+{
+	clear();
+}
+
+void TextCache::clear()
+{
+	for(auto & key_value : textures) {
+		SDL_DestroyTexture(key_value.second);
+	}
+	textures.clear();
+}
+
+SDL_Rect TextCache::getTextRect(const Sprites & sprites, const std::string & text, int scale)
+{
+	unsigned line_count = 1, max_width = 0, width = 0;
+	for(char ch : text) {
+		if(ch == '\n') {
+			++line_count;
+			width = 0;
+		} else {
+			++width;
+			max_width = std::max(max_width, width);
+		}
+	}
+	SDL_Rect char_rect = sprites.getCharRect(0);
+	SDL_Rect result;
+	result.x = 0;
+	result.y = 0;
+	result.w = char_rect.w * scale * max_width;
+	result.h = char_rect.h * scale * line_count;
+	return result;
+}
+
+void TextCache::paintText(SpriteBatch & batch, const Sprites & sprites, const std::string & text, int x, int y, int scale)
+{
+	SDL_Rect text_rect = getTextRect(sprites, text, scale);
+	SDL_Rect dest_rect;
+	dest_rect.w = sprites.getCharRect(0).w * scale;
+	dest_rect.h = sprites.getCharRect(0).h * scale;
+	dest_rect.y = y;
+	for(size_t line_start = 0; line_start <= text.size(); ) {
+		size_t line_end = text.find('\n', line_start);
+		if(line_end == std::string::npos) {
+			line_end = text.size();
+		}
+		dest_rect.x = x + (text_rect.w - dest_rect.w * int(line_end - line_start)) / 2;
+		for(size_t i = line_start; i < line_end; ++i) {
+			batch.add(sprites.getFont(), sprites.getCharRect(text[i]), dest_rect);
+			dest_rect.x += dest_rect.w;
+		}
+		dest_rect.y += dest_rect.h;
+		line_start = line_end + 1;
+	}
+}
+
+SDL_Texture * TextCache::getText(SDL_Renderer * painter, const std::string & text, int scale)
+{
+	std::pair<std::string, int> key(text, scale);
+	auto found = textures.find(key);
+	if(found != textures.end()) {
+		return found->second;
+	}
+
+	SDL_Rect text_rect = getTextRect(sprites, text, scale);
+	SDL_Texture * texture = createTargetTexture(painter, text_rect.w, text_rect.h);
+	if(!texture) {
+		return 0;
+	}
+	{
+		TargetGuard guard(painter, texture);
+		if(!guard.ok) {
+			SDL_DestroyTexture(texture);
+			return 0;
+		}
+		SDL_SetRenderDrawColor(painter, 0, 0, 0, 0);
+		SDL_RenderClear(painter);
+		batch.begin(painter);
+		paintText(batch, sprites, text, 0, 0, scale);
+		batch.end();
+	}
+	if(textures.size() >= MAX_CACHED_TEXTS) {
+		clear();
+	}
+	textures[key] = texture;
+	return texture;
+}
+
+TextLine::TextLine(const Sprites & _sprites, unsigned line_capacity, int text_scale)
+	: sprites(_sprites), capacity(line_capacity), scale(text_scale), texture(0)
+{
+}
+
+TextLine::~TextLine()
+{
+	if(texture) {
+		SDL_DestroyTexture(texture);
+	}
+}
+
+void TextLine::set_text(const std::string & line_text)
+{
+	text = line_text.substr(0, capacity);
+}
+
+void TextLine::invalidate()
+{
+	rendered.clear();
+	if(texture) {
+		SDL_DestroyTexture(texture);
+		texture = 0;
+	}
+}
+
+void TextLine::renderGlyphs(SDL_Renderer * painter, unsigned start, unsigned end)
+{
+	SDL_Rect dest_rect;
+	dest_rect.w = sprites.getCharRect(0).w * scale;
+	dest_rect.h = sprites.getCharRect(0).h * scale;
+	dest_rect.x = dest_rect.w * start;
+	dest_rect.y = 0;
+
+	TargetGuard guard(painter, texture);
+	if(!guard.ok) {
+		return;
+	}
+	SDL_Rect dirty_rect = dest_rect;
+	dirty_rect.w = dest_rect.w * (end - start);
+	SDL_SetRenderDrawBlendMode(painter, SDL_BLENDMODE_NONE);
+	SDL_SetRenderDrawColor(painter, 0, 0, 0, 0);
+	SDL_RenderFillRect(painter, &dirty_rect);
+
+	batch.begin(painter);
+	for(unsigned i = start; i < end && i < text.size(); ++i) {
+		batch.add(sprites.getFont(), sprites.getCharRect(text[i]), dest_rect);
+		dest_rect.x += dest_rect.w;
+	}
+	batch.end();
+}
+
+void TextLine::paint(SDL_Renderer * painter, int x, int y)
+{
+	SDL_Rect dest_rect;
+	dest_rect.x = x;
+	dest_rect.y = y;
+	dest_rect.w = sprites.getCharRect(0).w * scale * capacity;
+	dest_rect.h = sprites.getCharRect(0).h * scale;
+	std::string padded = text + std::string(capacity - text.size(), ' ');
+	if(!texture) {
+		texture = createTargetTexture(painter, dest_rect.w, dest_rect.h);
+		if(texture) {
+			renderGlyphs(painter, 0, capacity);
+			rendered = padded;
+		}
+	}
+	if(!texture) {
+		batch.begin(painter);
+		TextCache::paintText(batch, sprites, text, x, y, scale);
+		batch.end();
+		return;
+	}
+
+	unsigned start = 0, end = capacity;
+	while(start < end && padded[start] == rendered[start]) {
+		++start;
+	}
+	while(end > start && padded[end - 1] == rendered[end - 1]) {
+		--end;
+	}
+	if(start < end) {
+		renderGlyphs(painter, start, end);
+		rendered = padded;
+	}
+
+	SDL_Rect src_rect = dest_rect;
+	src_rect.x = 0;
+	src_rect.y = 0;
+	SDL_RenderCopy(painter, texture, &src_rect, &dest_rect);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "spritebatch.h"
+#include <map>
+#include <string>
+class Sprites;
+
+// Multiline text rendered from font atlas into textures, lines are centered.
+// Textures are kept for repeated text and scale until cache is full.
+class TextCache {
+public:
+	TextCache(const Sprites & _sprites);
+	~TextCache();
+
+	SDL_Texture * getText(SDL_Renderer * painter, const std::string & text, int scale);
+	void clear();
+
+	static SDL_Rect getTextRect(const Sprites & sprites, const std::string & text, int scale);
+	static void paintText(SpriteBatch & batch, const Sprites & sprites, const std::string & text, int x, int y, int scale);
+private:
+	const Sprites & sprites;
+	std::map<std::pair<std::string, int>, SDL_Texture *> textures;
+	SpriteBatch batch;
+
+	TextCache(const TextCache &) = delete;
+	TextCache & operator=(const TextCache &) = delete;
+};
+
+// Single line of text with fixed capacity, e.g. counters in HUD.
+// Only glyphs that differ from previously rendered text are re-rendered.
+class TextLine {
+public:
+	TextLine(const Sprites & _sprites, unsigned line_capacity, int text_scale);
+	~TextLine();
+
+	void set_text(const std::string & line_text);
+	void invalidate();
+	void paint(SDL_Renderer * painter, int x, int y);
+private:
+	const Sprites & sprites;
+	unsigned capacity;
+	int scale;
+	SDL_Texture * texture;
+	std::string text;
+	std::string rendered;
+	SpriteBatch batch;
+
+	TextLine(const TextLine &) = delete;
+	TextLine & operator=(const TextLine &) = delete;
+	void renderGlyphs(SDL_Renderer * painter, unsigned start, unsigned end);
+};
@@ -0,0 +1,78 @@
+#include "thumbnail.h"
+#include "sokoban.h"
+#include "sprites.h"
+#include <fstream>
+
+namespace {
+#include "../tmp/res/sokoban_pixels.h"
+
+// Tileset rows go in the same order as Sprites tile types, columns are sprite variants.
+const unsigned TILESET_COLUMNS = 4;
+const unsigned TILESET_ROWS = 9;
+const unsigned TILE_WIDTH = sokoban_width / TILESET_COLUMNS;
+const unsigned TILE_HEIGHT = sokoban_height / TILESET_ROWS;
+
+}
+
+Thumbnail::Thumbnail(const Sokoban & sokoban, int tile_size)
+	: image_width(sokoban.width() * tile_size), image_height(sokoban.height() * tile_size),
+	pixels(image_width * image_height, 0xff000000)
+{
+	for(int y = 0; y < sokoban.height(); ++y) {
+		for(int x = 0; x < sokoban.width(); ++x) {
+			Cell cell = sokoban.getCellAt(x, y);
+			int cellSprite = Sprites::SPACE;
+			switch(cell.type) {
+				case Cell::FLOOR: cellSprite = Sprites::FLOOR; break;
+				case Cell::SLOT: cellSprite = Sprites::EMPTY_SLOT; break;
+				case Cell::SPACE: cellSprite = Sprites::SPACE; break;
+				case Cell::WALL: cellSprite = Sprites::WALL; break;
+			}
+			drawTile(x, y, tile_size, cellSprite, cell.sprite);
+		}
+	}
+	std::vector<Object> objects = sokoban.getBoxes();
+	objects.push_back(sokoban.getPlayer());
+	for(const Object & object : objects) {
+		bool on_slot = sokoban.getCellAt(object.pos).type == Cell::SLOT;
+		int objectSprite = object.is_player
+			? (on_slot ? Sprites::PLAYER_ON_SLOT : Sprites::PLAYER_ON_FLOOR)
+			: (on_slot ? Sprites::BOX_ON_SLOT : Sprites::BOX_ON_FLOOR);
+		drawTile(object.pos.x, object.pos.y, tile_size, objectSprite, object.sprite);
+	}
+}
+
+void Thumbnail::drawTile(int cell_x, int cell_y, int tile_size, int tileType, int tileIndex)
+{
+	const unsigned int * tile = sokoban_pixels
+		+ tileType * TILE_HEIGHT * sokoban_width
+		+ (tileIndex % TILESET_COLUMNS) * TILE_WIDTH;
+	unsigned int * dest = &pixels[0] + cell_y * tile_size * image_width + cell_x * tile_size;
+	for(int y = 0; y < tile_size; ++y) {
+		const unsigned int * src_row = tile + (y * TILE_HEIGHT / tile_size) * sokoban_width;
+		for(int x = 0; x < tile_size; ++x) {
+			unsigned int color = src_row[x * TILE_WIDTH / tile_size];
+			// Tileset alpha is either fully transparent or fully opaque.
+			if(color & 0xff000000) {
+				dest[x] = color;
+			}
+		}
+		dest += image_width;
+	}
+}
+
+bool Thumbnail::savePPM(const std::string & file_name) const
+{
+	std::ofstream file(file_name.c_str(), std::ofstream::out | std::ofstream::binary);
+	file << "P6\n" << image_width << ' ' << image_height << "\n255\n";
+	std::vector<char> rgb(pixels.size() * 3);
+	for(unsigned i = 0; i < pixels.size(); ++i) {
+		rgb[i * 3] = char((pixels[i] >> 16) & 0xff);
+		rgb[i * 3 + 1] = char((pixels[i] >> 8) & 0xff);
+		rgb[i * 3 + 2] = char(pixels[i] & 0xff);
+	}
+	if(!rgb.empty()) {
+		file.write(&rgb[0], rgb.size());
+	}
+	return bool(file);
+}
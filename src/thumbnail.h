@@ -0,0 +1,20 @@
+#pragma once
+#include <string>
+#include <vector>
+class Sokoban;
+
+// Board image composited on CPU straight from level state and tileset pixels.
+// Does not need renderer or display, so it could be used from any thread.
+class Thumbnail {
+public:
+	Thumbnail(const Sokoban & sokoban, int tile_size);
+
+	int width() const { return image_width; }
+	int height() const { return image_height; }
+	unsigned int pixel(int x, int y) const { return pixels[y * image_width + x]; }
+	bool savePPM(const std::string & file_name) const;
+private:
+	int image_width, image_height;
+	std::vector<unsigned int> pixels;
+	void drawTile(int cell_x, int cell_y, int tile_size, int tileType, int tileIndex);
+};
@@ -0,0 +1,106 @@
+#include "../src/deadlock.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(deadlock) {
+
+std::vector<Chthon::Point> checkAll(const Sokoban & sokoban)
+{
+	DeadlockDetector detector;
+	detector.setLevel(sokoban);
+	std::vector<Chthon::Point> boxes;
+	for(const Object & box : sokoban.getBoxes()) {
+		boxes.push_back(box.pos);
+	}
+	return detector.check(sokoban, boxes);
+}
+
+TEST(should_find_box_on_dead_cell)
+{
+	Sokoban sokoban(
+			"######\n"
+			"#$  .#\n"
+			"#@   #\n"
+			"######"
+			);
+	std::vector<Chthon::Point> dead = checkAll(sokoban);
+	EQUAL(dead.size(), 1u);
+	EQUAL(dead[0], Chthon::Point(1, 1));
+}
+
+TEST(should_find_frozen_boxes)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#  .. #\n"
+			"# $$  #\n"
+			"# $$@ #\n"
+			"# ..  #\n"
+			"#######"
+			);
+	EQUAL(checkAll(sokoban).size(), 4u);
+}
+
+TEST(should_ignore_frozen_boxes_on_goals)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#**   #\n"
+			"#**  @#\n"
+			"#######"
+			);
+	ASSERT(checkAll(sokoban).empty());
+}
+
+TEST(should_ignore_movable_boxes)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#.  . #\n"
+			"# $$@ #\n"
+			"#     #\n"
+			"#######"
+			);
+	ASSERT(checkAll(sokoban).empty());
+}
+
+TEST(should_check_only_given_boxes)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#$ $..#\n"
+			"#    @#\n"
+			"#######"
+			);
+	DeadlockDetector detector;
+	detector.setLevel(sokoban);
+	ASSERT(detector.check(sokoban, std::vector<Chthon::Point>(1, Chthon::Point(3, 1))).empty());
+	EQUAL(detector.check(sokoban, std::vector<Chthon::Point>(1, Chthon::Point(1, 1))).size(), 1u);
+}
+
+TEST(should_follow_pushes_and_undo_between_checks)
+{
+	Sokoban sokoban(
+			"######\n"
+			"#    #\n"
+			"# $@.#\n"
+			"#    #\n"
+			"######"
+			);
+	DeadlockDetector detector;
+	detector.setLevel(sokoban);
+	std::vector<Chthon::Point> box(1, Chthon::Point(1, 2));
+	sokoban.movePlayer(Sokoban::LEFT);
+	EQUAL(detector.check(sokoban, box).size(), 1u);
+	sokoban.undo();
+	ASSERT(detector.check(sokoban, box).empty());
+	sokoban.movePlayer(Sokoban::LEFT);
+	sokoban.movePlayer(Sokoban::DOWN);
+	EQUAL(detector.check(sokoban, box).size(), 1u);
+	sokoban.restart();
+	detector.setPosition(sokoban);
+	ASSERT(detector.check(sokoban, std::vector<Chthon::Point>(1, Chthon::Point(2, 2))).empty());
+	ASSERT(detector.check(sokoban, box).empty());
+}
+
+}
@@ -0,0 +1,48 @@
+#include "../src/generator.h"
+#include "../src/solver.h"
+#include "../src/solution.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(generator) {
+
+bool generateFirst(const Generator::Options & options, unsigned & seed, Generator::Level & level)
+{
+	for(seed = 1; seed < 100; ++seed) {
+		if(Generator::generate(options, seed, level)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+TEST(should_generate_solvable_level)
+{
+	Generator::Options options;
+	options.min_pushes = 5;
+	unsigned seed = 0;
+	Generator::Level level;
+	ASSERT(generateFirst(options, seed, level));
+	Sokoban sokoban(level.field);
+	EQUAL(sokoban.width(), options.width);
+	EQUAL(sokoban.height(), options.height);
+	Solver::Result result = Solver(sokoban).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	ASSERT(result.pushes >= options.min_pushes);
+	ASSERT(Solution(result.solution).verify(sokoban));
+}
+
+TEST(should_generate_the_same_level_from_the_same_seed)
+{
+	Generator::Options options;
+	options.min_pushes = 5;
+	unsigned seed = 0;
+	Generator::Level level;
+	ASSERT(generateFirst(options, seed, level));
+	Generator::Level again;
+	ASSERT(Generator::generate(options, seed, again));
+	EQUAL(again.field, level.field);
+	EQUAL(again.pushes, level.pushes);
+}
+
+}
@@ -0,0 +1,87 @@
+#include "../src/hintengine.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(hintengine) {
+
+const int WAIT_MSEC = 5000;
+
+TEST(should_suggest_next_push)
+{
+	Sokoban sokoban("#@ $ .#");
+	HintEngine hints;
+	hints.setLevel(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	HintEngine::Hint hint = hints.getHint();
+	EQUAL(hint.status, HintEngine::PUSH);
+	EQUAL(hint.box, Chthon::Point(3, 0));
+	EQUAL(hint.direction, int(Sokoban::RIGHT));
+}
+
+TEST(should_report_lost_position)
+{
+	Sokoban sokoban(
+			"######\n"
+			"#  $.#\n"
+			"#@   #\n"
+			"######"
+			);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::UP);
+	sokoban.movePlayer(Sokoban::LEFT);
+	sokoban.movePlayer(Sokoban::LEFT);
+	HintEngine hints;
+	hints.setLevel(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	EQUAL(hints.getHint().status, HintEngine::LOST);
+}
+
+TEST(should_take_next_push_from_known_path)
+{
+	Sokoban sokoban("#@ $  .#");
+	HintEngine hints;
+	hints.setLevel(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	hints.setPosition(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	HintEngine::Hint hint = hints.getHint();
+	EQUAL(hint.status, HintEngine::PUSH);
+	EQUAL(hint.box, Chthon::Point(4, 0));
+}
+
+TEST(should_search_again_when_position_leaves_path)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#@ $ .#\n"
+			"#     #\n"
+			"#######"
+			);
+	HintEngine hints;
+	hints.setLevel(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	sokoban.movePlayer(Sokoban::DOWN);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::UP);
+	sokoban.movePlayer(Sokoban::LEFT);
+	sokoban.movePlayer(Sokoban::LEFT);
+	hints.setPosition(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	HintEngine::Hint hint = hints.getHint();
+	EQUAL(hint.status, HintEngine::PUSH);
+	EQUAL(hint.box, Chthon::Point(2, 1));
+
+	sokoban.restart();
+	hints.setPosition(sokoban);
+	ASSERT(hints.waitForHint(WAIT_MSEC));
+	EQUAL(hints.getHint().box, Chthon::Point(3, 1));
+}
+
+}
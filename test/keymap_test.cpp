@@ -0,0 +1,34 @@
+#include "../src/keymap.h"
+#include "../src/playingmode.h"
+#include <chthon2/test.h>
+
+SUITE(keymap) {
+
+TEST(should_bind_keys_with_modifiers)
+{
+	Keymap keymap;
+	keymap.loadFromString("Ctrl-Z undo\nShift-Left run_left\nLeft left\n");
+	EQUAL(keymap.getControl(SDLK_z, KMOD_LCTRL), int(Game::CONTROL_UNDO));
+	EQUAL(keymap.getControl(SDLK_z, KMOD_NONE), int(Game::CONTROL_NONE));
+	EQUAL(keymap.getControl(SDLK_LEFT, KMOD_RSHIFT), int(Game::CONTROL_RUN_LEFT));
+	EQUAL(keymap.getControl(SDLK_LEFT, KMOD_NONE), int(Game::CONTROL_LEFT));
+}
+
+TEST(should_override_default_bindings)
+{
+	Keymap keymap;
+	keymap.loadDefaults();
+	EQUAL(keymap.getControl(SDLK_q, KMOD_NONE), int(Game::CONTROL_QUIT));
+	keymap.loadFromString("# Comment.\nQ none\n");
+	EQUAL(keymap.getControl(SDLK_q, KMOD_NONE), int(Game::CONTROL_NONE));
+	EQUAL(keymap.getControl(SDLK_q, KMOD_LCTRL), int(Game::CONTROL_QUIT));
+}
+
+TEST(should_report_invalid_bindings)
+{
+	Keymap keymap;
+	ASSERT(!keymap.loadFromString("Ctrl-Z nothing\n"));
+	ASSERT(!keymap.loadFromString("NoSuchKey undo\n"));
+}
+
+}
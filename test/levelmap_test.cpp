@@ -0,0 +1,137 @@
+#include "../src/levelmap.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(levelmap) {
+
+TEST(should_index_only_non_wall_cells)
+{
+	LevelMap map(Sokoban("#@$.#\n#####"));
+	EQUAL(map.getCellCount(), 3);
+	EQUAL(map.getCellIndex(Chthon::Point(0, 0)), int(LevelMap::NO_CELL));
+	EQUAL(map.getCellIndex(Chthon::Point(5, 0)), int(LevelMap::NO_CELL));
+	EQUAL(map.getCellPos(map.getCellIndex(Chthon::Point(2, 0))), Chthon::Point(2, 0));
+}
+
+TEST(should_link_neighbour_cells)
+{
+	LevelMap map(Sokoban("#@$.#\n#####"));
+	int player = map.getCellIndex(Chthon::Point(1, 0));
+	int box = map.getCellIndex(Chthon::Point(2, 0));
+	EQUAL(map.getNeighbour(player, Sokoban::RIGHT), box);
+	EQUAL(map.getNeighbour(box, Sokoban::LEFT), player);
+	EQUAL(map.getNeighbour(player, Sokoban::LEFT), int(LevelMap::NO_CELL));
+	EQUAL(map.getNeighbour(player, Sokoban::DOWN), int(LevelMap::NO_CELL));
+}
+
+TEST(should_find_goals_and_objects)
+{
+	Sokoban sokoban("#@$.#\n#####");
+	LevelMap map(sokoban);
+	EQUAL(map.getGoals().size(), 1u);
+	ASSERT(map.isGoal(map.getCellIndex(Chthon::Point(3, 0))));
+	EQUAL(map.getPlayerIndex(sokoban), map.getCellIndex(Chthon::Point(1, 0)));
+	EQUAL(map.getBoxIndices(sokoban).size(), 1u);
+	EQUAL(map.getBoxIndices(sokoban)[0], map.getCellIndex(Chthon::Point(2, 0)));
+}
+
+TEST(should_mark_cells_from_which_box_cannot_reach_goals_as_dead)
+{
+	LevelMap map(Sokoban(
+				"######\n"
+				"#@   #\n"
+				"#  . #\n"
+				"######"
+				));
+	ASSERT(map.isDead(map.getCellIndex(Chthon::Point(1, 1))));
+	ASSERT(map.isDead(map.getCellIndex(Chthon::Point(2, 1))));
+	ASSERT(!map.isDead(map.getCellIndex(Chthon::Point(3, 2))));
+	EQUAL(map.getGoalDistance(map.getCellIndex(Chthon::Point(2, 2))), 1);
+	EQUAL(map.getGoalDistance(map.getCellIndex(Chthon::Point(1, 2))), -1);
+}
+
+TEST(should_push_box_to_target_by_minimal_number_of_pushes)
+{
+	Sokoban sokoban(
+			"######\n"
+			"#@   #\n"
+			"# $  #\n"
+			"#   .#\n"
+			"######"
+			);
+	LevelMap map(sokoban);
+	std::vector<char> occupied(map.getCellCount(), 0);
+	int player = LevelMap::NO_CELL;
+	std::string path;
+	int pushes = map.pushBox(occupied, map.getPlayerIndex(sokoban), map.getCellIndex(Chthon::Point(2, 2)), map.getCellIndex(Chthon::Point(4, 3)), player, &path);
+	EQUAL(pushes, 3);
+	EQUAL(path, "dRRurD");
+	EQUAL(map.getCellPos(player), Chthon::Point(4, 2));
+	int corner = map.getCellIndex(Chthon::Point(1, 1));
+	EQUAL(map.pushBox(occupied, map.getPlayerIndex(sokoban), map.getCellIndex(Chthon::Point(2, 2)), corner, player), 2);
+	occupied[map.getNeighbour(corner, Sokoban::RIGHT)] = 1;
+	occupied[map.getNeighbour(corner, Sokoban::DOWN)] = 1;
+	EQUAL(map.pushBox(occupied, map.getCellIndex(Chthon::Point(4, 1)), map.getCellIndex(Chthon::Point(2, 2)), corner, player), -1);
+}
+
+TEST(should_find_goal_room_with_packing_order)
+{
+	Sokoban sokoban(
+			"##########\n"
+			"#... #   #\n"
+			"#..    $ #\n"
+			"#   #$ $ #\n"
+			"#####  $ #\n"
+			"    # $@ #\n"
+			"    #    #\n"
+			"    ######"
+			);
+	LevelMap map(sokoban);
+	ASSERT(map.getGoalRooms().empty());
+	map.findGoalRooms(map.getPlayerIndex(sokoban), map.getBoxIndices(sokoban));
+	EQUAL(map.getGoalRooms().size(), 1u);
+	const LevelMap::GoalRoom & room = map.getGoalRooms()[0];
+	EQUAL(map.getCellPos(room.entrance), Chthon::Point(4, 2));
+	EQUAL(room.cells.size(), 10u);
+	EQUAL(room.goals.size(), 5u);
+	EQUAL(room.packing_order.size(), 5u);
+	EQUAL(map.getCellPos(room.packing_order.front()), Chthon::Point(3, 1));
+	EQUAL(map.getGoalRoom(map.getCellIndex(Chthon::Point(1, 3))), 0);
+	EQUAL(map.getGoalRoom(room.entrance), -1);
+}
+
+TEST(should_not_find_goal_room_in_open_space)
+{
+	Sokoban sokoban(
+			"######\n"
+			"#@ $.#\n"
+			"# $. #\n"
+			"######"
+			);
+	LevelMap map(sokoban);
+	map.findGoalRooms(map.getPlayerIndex(sokoban), map.getBoxIndices(sokoban));
+	ASSERT(map.getGoalRooms().empty());
+}
+
+TEST(should_find_tunnels_and_articulation_cells)
+{
+	LevelMap map(Sokoban(
+				"#######\n"
+				"#@ #  #\n"
+				"#     #\n"
+				"####$##\n"
+				"   #.#\n"
+				"   ###"
+				));
+	int door = map.getCellIndex(Chthon::Point(3, 2));
+	ASSERT(map.isTunnel(door, Sokoban::LEFT));
+	ASSERT(map.isTunnel(door, Sokoban::RIGHT));
+	ASSERT(!map.isTunnel(door, Sokoban::UP));
+	ASSERT(map.isArticulation(door));
+	int shaft = map.getCellIndex(Chthon::Point(4, 3));
+	ASSERT(map.isTunnel(shaft, Sokoban::DOWN));
+	ASSERT(map.isArticulation(shaft));
+	ASSERT(!map.isArticulation(map.getCellIndex(Chthon::Point(1, 2))));
+}
+
+}
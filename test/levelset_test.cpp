@@ -97,4 +97,46 @@ TEST(should_be_over_when_there_is_no_next_level)
 	ASSERT(levelset.isOver());
 }
 
+TEST(should_load_prefetched_next_level_as_it_is)
+{
+	LevelSet levelset;
+	levelset.loadFromString(xml, 0);
+	levelset.moveToNextLevel();
+	const char * level =
+		" #####\n"
+		"#  @ #\n"
+		"#  $ #\n"
+		"# #.##\n"
+		"##### "
+		;
+	EQUAL(levelset.getCurrentLevelName(), "Two");
+	EQUAL(levelset.getCurrentSokoban().toString(), level);
+}
+
+TEST(should_prepare_level_map_with_prefetched_level)
+{
+	LevelSet levelset;
+	levelset.loadFromString(xml, 0);
+	levelset.moveToNextLevel();
+	const LevelMap & map = *levelset.getCurrentLevelMap();
+	EQUAL(map.width(), levelset.getCurrentSokoban().width());
+	EQUAL(map.getPlayerIndex(levelset.getCurrentSokoban()), map.getCellIndex(Chthon::Point(3, 1)));
+	EQUAL(map.getGoals().size(), 1u);
+}
+
+TEST(should_load_proper_level_after_rewinding_past_prefetched_one)
+{
+	LevelSet levelset;
+	levelset.loadFromString(xml, 0);
+	levelset.rewindToLevel(2);
+	levelset.moveToNextLevel();
+	EQUAL(levelset.getCurrentLevelName(), "Three");
+	EQUAL(levelset.getCurrentSokoban().toString(),
+		"   ####\n"
+		"####  #\n"
+		"# @$. #\n"
+		"#######"
+		);
+}
+
 }
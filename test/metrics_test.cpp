@@ -0,0 +1,56 @@
+#include "../src/metrics.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(metrics) {
+
+TEST(should_measure_level_structure)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#@ $ .#\n"
+			"#  $ .#\n"
+			"#######"
+			);
+	LevelMetrics metrics = LevelMetrics::analyze(sokoban, Solver::Limits());
+	EQUAL(metrics.box_count, 2);
+	EQUAL(metrics.floor_area, 10);
+	EQUAL(metrics.goal_rooms, 0);
+	EQUAL(metrics.dead_ratio, 0.2);
+}
+
+TEST(should_measure_goal_rooms)
+{
+	Sokoban sokoban(
+			"##########\n"
+			"#... #   #\n"
+			"#..    $ #\n"
+			"#   #$ $ #\n"
+			"#####  $ #\n"
+			"    # $@ #\n"
+			"    #    #\n"
+			"    ######"
+			);
+	LevelMetrics metrics = LevelMetrics::analyze(sokoban, Solver::Limits());
+	EQUAL(metrics.goal_rooms, 1);
+	EQUAL(metrics.largest_goal_room, 10);
+	EQUAL(metrics.room_goals, 5);
+	EQUAL(metrics.packed_goals, 5);
+}
+
+TEST(should_include_search_effort)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#.#  .#\n"
+			"#$# $ #\n"
+			"#@    #\n"
+			"#######"
+			);
+	LevelMetrics metrics = LevelMetrics::analyze(sokoban, Solver::Limits());
+	EQUAL(metrics.search.status, Solver::SOLVED);
+	EQUAL(metrics.search.pushes, 3);
+	ASSERT(metrics.search.nodes > 0);
+}
+
+}
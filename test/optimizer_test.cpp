@@ -0,0 +1,70 @@
+#include "../src/optimizer.h"
+#include "../src/solution.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(optimizer) {
+
+const char * LEVEL =
+	"#######\n"
+	"#@ $ .#\n"
+	"#     #\n"
+	"#######"
+	;
+
+TEST(should_remove_unneeded_pushes)
+{
+	Sokoban sokoban(LEVEL);
+	Optimizer::Result result = Optimizer(sokoban).optimize("rRdrruLdlluRR", Optimizer::Options());
+	ASSERT(result.valid);
+	EQUAL(result.pushes_before, 4);
+	EQUAL(result.moves_before, 13);
+	EQUAL(result.solution, "rRR");
+	EQUAL(result.pushes, 2);
+	EQUAL(result.moves, 3);
+}
+
+TEST(should_shorten_player_walks)
+{
+	Sokoban sokoban(LEVEL);
+	Optimizer::Result result = Optimizer(sokoban).optimize("drlurRR", Optimizer::Options());
+	ASSERT(result.valid);
+	EQUAL(result.pushes_before, 2);
+	EQUAL(result.solution, "rRR");
+	ASSERT(Solution(result.solution).verify(sokoban));
+}
+
+TEST(should_count_windows_that_cannot_be_solved)
+{
+	// 300x220 floor cells do not fit into solver states, so only walks are rebuilt.
+	std::string wall(302, '#');
+	std::string field = wall + "\n#@$." + std::string(297, ' ') + "#\n";
+	for(int y = 1; y < 220; ++y) {
+		field += "#" + std::string(300, ' ') + "#\n";
+	}
+	field += wall;
+	Sokoban sokoban(field);
+	Optimizer::Result result = Optimizer(sokoban).optimize("duR", Optimizer::Options());
+	ASSERT(result.valid);
+	EQUAL(result.solution, "R");
+	EQUAL(result.windows, 1);
+	EQUAL(result.unsolved_windows, 1);
+}
+
+TEST(should_solve_windows_on_the_same_map)
+{
+	Sokoban sokoban(LEVEL);
+	Optimizer::Result result = Optimizer(sokoban).optimize("rRdrruLdlluRR", Optimizer::Options());
+	ASSERT(result.windows > 0);
+	EQUAL(result.unsolved_windows, 0);
+}
+
+TEST(should_reject_solution_that_does_not_solve_level)
+{
+	Sokoban sokoban(LEVEL);
+	ASSERT(!Optimizer(sokoban).optimize("rR", Optimizer::Options()).valid);
+	ASSERT(!Optimizer(sokoban).optimize("lrR", Optimizer::Options()).valid);
+	ASSERT(!Optimizer(sokoban).optimize("rRx", Optimizer::Options()).valid);
+}
+
+}
@@ -0,0 +1,66 @@
+#include "../src/packedstate.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(packedstate) {
+
+TEST(should_pack_sorted_boxes_and_player)
+{
+	Sokoban sokoban("#.$@$.#");
+	LevelMap map(sokoban);
+	std::vector<uint16_t> state = PackedState::fromSokoban(map, sokoban);
+	EQUAL(state.size(), PackedState::getSize(2));
+	EQUAL(int(state[0]), map.getCellIndex(Chthon::Point(2, 0)));
+	EQUAL(int(state[1]), map.getCellIndex(Chthon::Point(4, 0)));
+	EQUAL(int(state[2]), map.getCellIndex(Chthon::Point(3, 0)));
+}
+
+TEST(should_restore_sokoban_from_state)
+{
+	Sokoban level(
+			"######\n"
+			"#@$ .#\n"
+			"# $ *#\n"
+			"######"
+			);
+	LevelMap map(level);
+	Sokoban moved = level;
+	moved.movePlayer(Sokoban::RIGHT);
+	moved.movePlayer(Sokoban::RIGHT);
+	std::vector<uint16_t> state = PackedState::fromSokoban(map, moved);
+	Sokoban restored = PackedState::toSokoban(map, level, &state[0]);
+	EQUAL(restored.toString(), moved.toString());
+	ASSERT(restored.historyAsString().empty());
+}
+
+TEST(should_hash_equal_states_equally)
+{
+	uint16_t a[] = { 1, 2, 3, 4, 5, 6 };
+	uint16_t b[] = { 1, 2, 3, 4, 5, 6 };
+	uint16_t c[] = { 1, 2, 3, 4, 5, 7 };
+	ASSERT(PackedState::equal(a, b, 6));
+	ASSERT(!PackedState::equal(a, c, 6));
+	EQUAL(PackedState::hash(a, 6), PackedState::hash(b, 6));
+	ASSERT(PackedState::hash(a, 6) != PackedState::hash(c, 6));
+}
+
+TEST(should_store_every_state_once)
+{
+	StateArena arena(3);
+	bool added = false;
+	for(uint16_t i = 0; i < 5000; ++i) {
+		uint16_t state[] = { i, uint16_t(i + 1), 7 };
+		EQUAL(arena.insert(state, added), unsigned(i));
+		ASSERT(added);
+	}
+	uint16_t existing[] = { 100, 101, 7 };
+	EQUAL(arena.insert(existing, added), 100u);
+	ASSERT(!added);
+	EQUAL(arena.size(), 5000u);
+	EQUAL(arena.find(existing), 100u);
+	uint16_t missing[] = { 100, 101, 8 };
+	EQUAL(arena.find(missing), unsigned(StateArena::NOT_FOUND));
+	EQUAL(int(arena.get(4999)[1]), 5000);
+}
+
+}
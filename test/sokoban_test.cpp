@@ -272,6 +272,24 @@ TEST(historyIsTracked)
 	EQUAL(sokoban.historyAsString(), "rRll");
 }
 
+TEST(historyCountersFollowStepsAndUndo)
+{
+	EQUAL(Sokoban("#@ $.$", "rL").getHistoryMoves(), 2);
+	EQUAL(Sokoban("#@ $.$", "rL").getHistoryPushes(), 1);
+	Sokoban sokoban("#@ $.$");
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	EQUAL(sokoban.getHistoryMoves(), 2);
+	EQUAL(sokoban.getHistoryPushes(), 1);
+	sokoban.undo();
+	EQUAL(sokoban.getHistoryMoves(), 1);
+	EQUAL(sokoban.getHistoryPushes(), 0);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.restart();
+	EQUAL(sokoban.getHistoryMoves(), 0);
+	EQUAL(sokoban.getHistoryPushes(), 0);
+}
+
 TEST(historyIsTrackedWithUndo)
 {
 	Sokoban sokoban("#@ $.$", "", true);
@@ -313,6 +331,43 @@ TEST(historyIsTrackedWithUndo)
 	EQUAL(sokoban.historyAsString(), "rRll---R--rR");
 }
 
+TEST(should_not_undo_cancelled_steps_in_full_history)
+{
+	Sokoban sokoban("@   #", "", true);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.undo();
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.undo();
+	ASSERT(sokoban.undo());
+	EQUAL(sokoban.toString(), "@   #");
+	EQUAL(sokoban.historyAsString(), "rr-r--");
+	ASSERT(!sokoban.undo());
+}
+
+TEST(should_count_engine_effort)
+{
+	Sokoban sokoban("@ $.");
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.undo();
+	sokoban.movePlayer(Chthon::Point(0, 0));
+	const Sokoban::Counters & counters = sokoban.getCounters();
+#ifdef MINIBAN_COUNTERS
+	EQUAL(counters.loads, 1u);
+	EQUAL(counters.moves, 3u);
+	EQUAL(counters.pushes, 1u);
+	EQUAL(counters.undos, 1u);
+	EQUAL(counters.pathfinding_calls, 1u);
+	ASSERT(counters.visited_cells > 0);
+#else
+	EQUAL(counters.moves, 0u);
+#endif
+	sokoban.resetCounters();
+	EQUAL(sokoban.getCounters().moves, 0u);
+	EQUAL(sokoban.getCounters().loads, 0u);
+}
+
 TEST(should_win_when_empty)
 {
 	Sokoban sokoban("@ ");
@@ -367,6 +422,36 @@ TEST(should_not_win_when_three_boxes_and_four_slots)
 	ASSERT(!sokoban.isSolved());
 }
 
+TEST(should_win_after_push_onto_last_slot_and_not_after_undo)
+{
+	Sokoban sokoban("######\n#@$.*#\n######");
+	ASSERT(!sokoban.isSolved());
+	sokoban.movePlayer(Sokoban::RIGHT);
+	ASSERT(sokoban.isSolved());
+	sokoban.undo();
+	ASSERT(!sokoban.isSolved());
+}
+
+TEST(should_not_win_when_box_is_pushed_off_slot)
+{
+	Sokoban sokoban("#######\n#@*  .#\n#######");
+	sokoban.movePlayer(Sokoban::RIGHT);
+	ASSERT(!sokoban.isSolved());
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	ASSERT(!sokoban.isSolved());
+}
+
+TEST(should_set_position_and_clear_history)
+{
+	Sokoban sokoban("#@$ .#");
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.setPosition(Chthon::Point(2, 0), std::vector<Chthon::Point>(1, Chthon::Point(4, 0)));
+	EQUAL(sokoban.toString(), "# @ *#");
+	EQUAL(sokoban.historyAsString(), "");
+	ASSERT(sokoban.isSolved());
+}
+
 TEST(undoMovement)
 {
 	Sokoban sokoban(".* \n.$@");
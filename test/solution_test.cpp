@@ -0,0 +1,106 @@
+#include "../src/solution.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+#include <sstream>
+
+SUITE(solution) {
+
+TEST(should_pack_two_steps_per_byte)
+{
+	Solution solution("lrDUu");
+	EQUAL(solution.size(), 5u);
+	EQUAL(solution.getPackedSteps().size(), 3u);
+	EQUAL(solution.stepAt(0), int(Sokoban::LEFT));
+	EQUAL(solution.stepAt(2), int(Sokoban::DOWN | Solution::PUSH_FLAG));
+}
+
+TEST(should_decode_history_as_it_was)
+{
+	std::string history = "rrRRllUUddDLrul--u-";
+	EQUAL(Solution(history).toString(), history);
+}
+
+TEST(should_decode_empty_history)
+{
+	EQUAL(Solution("").toString(), "");
+	EQUAL(Solution().toString(), "");
+}
+
+TEST(should_not_accept_invalid_steps)
+{
+	CATCH(Solution("lrx"), const Solution::InvalidStepException & e) {
+		EQUAL(e.invalidStep, 'x');
+	}
+}
+
+TEST(should_save_and_load_solution)
+{
+	Solution solution("rRlLuUdD-");
+	std::ostringstream out;
+	solution.save(out);
+	EQUAL(out.str().size(), size_t(Solution::HEADER_SIZE + 5));
+	std::istringstream in(out.str());
+	EQUAL(Solution::load(in).toString(), "rRlLuUdD-");
+}
+
+TEST(should_not_load_data_with_wrong_magic)
+{
+	std::istringstream in(std::string("XXXX\x01\0\0\0\0\0\0\0", 12));
+	CATCH(Solution::load(in), const Solution::InvalidFormatException & e) {
+	}
+}
+
+TEST(should_not_load_truncated_data)
+{
+	std::ostringstream out;
+	Solution("rrrr").save(out);
+	std::istringstream in(out.str().substr(0, out.str().size() - 1));
+	CATCH(Solution::load(in), const Solution::InvalidFormatException & e) {
+	}
+}
+
+TEST(should_not_load_data_with_nonzero_reserved_bytes)
+{
+	std::ostringstream out;
+	Solution("rR").save(out);
+	std::string data = out.str();
+	data[6] = 1;
+	std::istringstream in(data);
+	CATCH(Solution::load(in), const Solution::InvalidFormatException & e) {
+	}
+}
+
+TEST(should_not_load_data_shorter_than_huge_step_count)
+{
+	std::string data("MNBS\x01\0\0\0\xff\xff\xff\xff", 12);
+	std::istringstream in(data + "rRrR");
+	CATCH(Solution::load(in), const Solution::InvalidFormatException & e) {
+	}
+}
+
+TEST(should_replay_solution_on_level)
+{
+	Sokoban sokoban("@ $.");
+	ASSERT(Solution("rR").replay(sokoban));
+	EQUAL(sokoban.toString(), "  @*");
+	EQUAL(sokoban.historyAsString(), "rR");
+}
+
+TEST(should_verify_correct_solution)
+{
+	Sokoban sokoban("@ $.");
+	ASSERT(Solution("rR").verify(sokoban));
+	ASSERT(!Solution("r").verify(sokoban));
+	ASSERT(!Solution("l").verify(sokoban));
+	EQUAL(sokoban.toString(), "@ $.");
+}
+
+TEST(should_not_verify_solution_with_wrong_push_marks)
+{
+	Sokoban sokoban("@ $.");
+	ASSERT(!Solution("rr").verify(sokoban));
+	ASSERT(!Solution("RR").verify(sokoban));
+	ASSERT(Solution("rR-R").verify(sokoban));
+}
+
+}
@@ -0,0 +1,197 @@
+#include "../src/solver.h"
+#include "../src/solution.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+
+SUITE(solver) {
+
+TEST(should_solve_simple_level)
+{
+	Sokoban sokoban("#@ $.#");
+	Solver::Result result = Solver(sokoban).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	EQUAL(result.solution, "rR");
+	EQUAL(result.moves, 2);
+	EQUAL(result.pushes, 1);
+}
+
+TEST(should_find_solution_that_solves_level)
+{
+	Sokoban sokoban(
+			"#######\n"
+			"#.@ # #\n"
+			"#$* $ #\n"
+			"#   $ #\n"
+			"# ..  #\n"
+			"#  *  #\n"
+			"#######"
+			);
+	Solver::Result result = Solver(sokoban).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	ASSERT(Solution(result.solution).verify(sokoban));
+	ASSERT(result.nodes > 0);
+}
+
+TEST(should_solve_from_current_position)
+{
+	Sokoban sokoban("#@ $ .#");
+	sokoban.movePlayer(Sokoban::RIGHT);
+	sokoban.movePlayer(Sokoban::RIGHT);
+	Solver::Result result = Solver(sokoban).solve(Solver::Limits());
+	EQUAL(result.solution, "R");
+}
+
+TEST(should_report_unsolvable_level)
+{
+	EQUAL(Solver(Sokoban("#@$#.#")).solve(Solver::Limits()).status, Solver::UNSOLVABLE);
+	EQUAL(Solver(Sokoban("#..$$@#")).solve(Solver::Limits()).status, Solver::UNSOLVABLE);
+	EQUAL(Solver(Sokoban("#@$ ..#")).solve(Solver::Limits()).status, Solver::UNSOLVABLE);
+}
+
+TEST(should_push_boxes_into_goal_room_as_macro_steps)
+{
+	Sokoban sokoban(
+			"##########\n"
+			"#... #   #\n"
+			"#..    $ #\n"
+			"#   #$ $ #\n"
+			"#####  $ #\n"
+			"    # $@ #\n"
+			"    #    #\n"
+			"    ######"
+			);
+	Solver::Options plain;
+	plain.goal_room_macros = false;
+	Solver::Result without_macros = Solver(sokoban, plain).solve(Solver::Limits());
+	Solver::Result result = Solver(sokoban).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	ASSERT(Solution(result.solution).verify(sokoban));
+	EQUAL(without_macros.status, Solver::SOLVED);
+	ASSERT(result.nodes < without_macros.nodes);
+}
+
+TEST(should_repeat_search_without_macros_before_reporting_unsolvable)
+{
+	// Search with goal room macros runs out of nodes here, the level is solved by the repeated search without them.
+	Sokoban sokoban(
+			"#######\n"
+			"# #.  #\n"
+			"# .   #\n"
+			"# # ###\n"
+			"#@$ $ #\n"
+			"#     #\n"
+			"#######"
+			);
+	Solver::Options rooms(false);
+	rooms.goal_room_macros = true;
+	Solver::Result result = Solver(sokoban, rooms).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	ASSERT(Solution(result.solution).verify(sokoban));
+	EQUAL(Solver(sokoban).solve(Solver::Limits()).status, Solver::SOLVED);
+}
+
+TEST(should_search_less_with_tunnels_and_pi_corrals)
+{
+	Sokoban sokoban(
+			"##########\n"
+			"#   #    #\n"
+			"# $ $  $ #\n"
+			"#   ## # #\n"
+			"### #  $ #\n"
+			"  # #### #\n"
+			"  #      #\n"
+			"  # #### #\n"
+			"  # #  # #\n"
+			"  # #  #.#\n"
+			"  # #  #.#\n"
+			"  #@#  #.#\n"
+			"  ###  #.#\n"
+			"       ###"
+			);
+	// Goal room macros are off in both runs, so only tunnels and corrals are compared.
+	Solver::Options pruning(false);
+	pruning.tunnel_macros = true;
+	pruning.pi_corrals = true;
+	Solver::Result without_pruning = Solver(sokoban, Solver::Options(false)).solve(Solver::Limits());
+	Solver::Result result = Solver(sokoban, pruning).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	ASSERT(Solution(result.solution).verify(sokoban));
+	EQUAL(result.pushes, without_pruning.pushes);
+	ASSERT(result.nodes * 4 < without_pruning.nodes);
+}
+
+TEST(should_not_take_corral_for_lost_when_its_box_can_be_pushed_from_another_corral)
+{
+	// Player is shut in by three boxes. Box above him closes a one-cell corral on its left,
+	// and can be pushed out of it only from the big corral above, which player has to open first.
+	Sokoban sokoban(
+			"########\n"
+			"##     #\n"
+			"# $ #  #\n"
+			"##@$   #\n"
+			"# $    #\n"
+			"# . .. #\n"
+			"##    ##\n"
+			"########"
+			);
+	Solver::Options corrals(false);
+	corrals.pi_corrals = true;
+	Solver::Result result = Solver(sokoban, corrals).solve(Solver::Limits());
+	Solver::Result without_pruning = Solver(sokoban, Solver::Options(false)).solve(Solver::Limits());
+	EQUAL(result.status, Solver::SOLVED);
+	ASSERT(Solution(result.solution).verify(sokoban));
+	// Position taken for lost would add the repeated search without pruning to the pruned one.
+	ASSERT(result.nodes < without_pruning.nodes);
+}
+
+TEST(should_refuse_level_with_more_cells_than_states_can_hold)
+{
+	// 300x220 floor cells do not fit into 16-bit cell indices.
+	std::string wall(302, '#');
+	std::string field = wall + "\n#@$." + std::string(297, ' ') + "#\n";
+	for(int y = 1; y < 220; ++y) {
+		field += "#" + std::string(300, ' ') + "#\n";
+	}
+	field += wall;
+	Solver::Result result = Solver(Sokoban(field)).solve(Solver::Limits());
+	EQUAL(result.status, Solver::TOO_LARGE);
+	EQUAL(result.nodes, 0u);
+}
+
+TEST(should_stop_when_cancelled)
+{
+	Sokoban sokoban(
+			"##########\n"
+			"#@       #\n"
+			"# $ $ $ $#\n"
+			"#        #\n"
+			"# $ $ $ $#\n"
+			"#        #\n"
+			"#........#\n"
+			"##########"
+			);
+	std::atomic<bool> cancel(true);
+	EQUAL(Solver(sokoban).solve(Solver::Limits(), &cancel).status, Solver::CANCELLED);
+}
+
+TEST(should_stop_at_node_limit)
+{
+	Sokoban sokoban(
+			"##########\n"
+			"#@       #\n"
+			"# $ $ $ $#\n"
+			"#        #\n"
+			"# $ $ $ $#\n"
+			"#        #\n"
+			"#........#\n"
+			"##########"
+			);
+	Solver::Limits limits;
+	limits.nodes = 1000;
+	Solver::Result result = Solver(sokoban).solve(limits);
+	EQUAL(result.status, Solver::TIMEOUT);
+	ASSERT(result.nodes > 1000);
+	EQUAL(Solver(sokoban).solve(limits).nodes, result.nodes);
+}
+
+}
@@ -0,0 +1,33 @@
+#include "../src/thumbnail.h"
+#include "../src/sokoban.h"
+#include <chthon2/test.h>
+#include <cstdlib>
+
+SUITE(thumbnail) {
+
+TEST(should_render_every_cell_as_tile_of_given_size)
+{
+	Sokoban sokoban("#@$.#\n#####");
+	Thumbnail thumbnail(sokoban, 4);
+	EQUAL(thumbnail.width(), 20);
+	EQUAL(thumbnail.height(), 8);
+}
+
+TEST(should_draw_objects_over_cells)
+{
+	srand(1);
+	Sokoban with_player("#@ #");
+	srand(1);
+	Sokoban without_player("# @#");
+	Thumbnail thumbnail(with_player, 8);
+	Thumbnail other(without_player, 8);
+	bool differs = false;
+	for(int y = 0; y < 8; ++y) {
+		for(int x = 8; x < 16; ++x) {
+			differs = differs || thumbnail.pixel(x, y) != other.pixel(x, y);
+		}
+	}
+	ASSERT(differs);
+}
+
+}
@@ -0,0 +1,162 @@
+#include "../src/generator.h"
+#include <chthon2/format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <iostream>
+#include <cstdlib>
+
+namespace {
+
+const char * USAGE =
+	"Usage: miniban-generate <output.slc> [options]\n"
+	"  -n, --count <N>       number of levels (default is 10)\n"
+	"  -w, --width <N>       level width including walls (default is 10)\n"
+	"  -h, --height <N>      level height including walls (default is 8)\n"
+	"  -b, --boxes <N>       number of boxes (default is 3)\n"
+	"  -p, --min-pushes <N>  minimal solution length in pushes (default is 10)\n"
+	"  -l, --limit <N>       solver node limit for one candidate (default is 200000)\n"
+	"  -j, --threads <N>     number of worker threads (default is number of cores)\n"
+	"  -s, --seed <N>        seed of the first attempt (default is 1)\n"
+	;
+
+struct GeneratedLevel {
+	unsigned seed;
+	Generator::Level level;
+};
+
+void writeLevelSet(std::ostream & out, const std::string & title, const std::vector<GeneratedLevel> & levels, int width, int height)
+{
+	out << "<?xml version=\"1.0\" encoding=\"ISO-8859-1\"?>\n";
+	out << "<SokobanLevels>\n";
+	out << "  <Title>" << title << "</Title>\n";
+	out << Chthon::format("  <LevelCollection Copyright=\"Miniban\" MaxWidth=\"{0}\" MaxHeight=\"{1}\">\n", width, height);
+	for(const GeneratedLevel & generated : levels) {
+		out << Chthon::format("    <Level Id=\"{0}\" Width=\"{1}\" Height=\"{2}\">\n", generated.seed, width, height);
+		std::istringstream field(generated.level.field);
+		std::string row;
+		while(std::getline(field, row)) {
+			out << "      <L>" << row << "</L>\n";
+		}
+		out << "    </Level>\n";
+	}
+	out << "  </LevelCollection>\n";
+	out << "</SokobanLevels>\n";
+}
+
+}
+
+// Generates levels by all cores and writes them as .slc levelset.
+// Level ids are seeds, so any level can be generated again with the same options.
+int main(int argc, char ** argv)
+{
+	if(argc < 2) {
+		std::cerr << USAGE;
+		return 1;
+	}
+	Generator::Options options;
+	int count = 10;
+	int thread_count = std::thread::hardware_concurrency();
+	unsigned first_seed = 1;
+	for(int i = 2; i < argc; ++i) {
+		std::string option = argv[i];
+		if(i + 1 >= argc) {
+			std::cerr << USAGE;
+			return 1;
+		}
+		const char * value = argv[++i];
+		if(option == "-n" || option == "--count") {
+			count = atoi(value);
+		} else if(option == "-w" || option == "--width") {
+			options.width = atoi(value);
+		} else if(option == "-h" || option == "--height") {
+			options.height = atoi(value);
+		} else if(option == "-b" || option == "--boxes") {
+			options.box_count = atoi(value);
+		} else if(option == "-p" || option == "--min-pushes") {
+			options.min_pushes = atoi(value);
+		} else if(option == "-l" || option == "--limit") {
+			options.solve_nodes = strtoul(value, 0, 10);
+		} else if(option == "-j" || option == "--threads") {
+			thread_count = atoi(value);
+		} else if(option == "-s" || option == "--seed") {
+			first_seed = strtoul(value, 0, 10);
+		} else {
+			std::cerr << USAGE;
+			return 1;
+		}
+	}
+	thread_count = std::max(1, thread_count);
+	if(options.width < 3 || options.height < 3 || options.box_count < 1 || count < 1) {
+		std::cerr << USAGE;
+		return 1;
+	}
+
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start_time = Clock::now();
+	// Seeds are finished out of order, so levels are taken only from the prefix of seeds that are all finished.
+	// Output then is the first count accepted seeds whatever thread was faster.
+	std::map<unsigned, Generator::Level> accepted;
+	std::map<unsigned, bool> finished;
+	unsigned settled_seed = first_seed;
+	int settled_count = 0;
+	std::mutex levels_mutex;
+	std::atomic<unsigned> next_seed(first_seed);
+	std::vector<std::thread> workers;
+	for(int i = 0; i < thread_count; ++i) {
+		workers.push_back(std::thread([&]() {
+			for(;;) {
+				{
+					std::lock_guard<std::mutex> lock(levels_mutex);
+					if(settled_count >= count) {
+						return;
+					}
+				}
+				unsigned seed = next_seed++;
+				Generator::Level level;
+				bool is_accepted = Generator::generate(options, seed, level);
+				std::lock_guard<std::mutex> lock(levels_mutex);
+				if(is_accepted) {
+					accepted[seed] = level;
+				}
+				finished[seed] = is_accepted;
+				std::map<unsigned, bool>::iterator it = finished.begin();
+				for(; it != finished.end() && it->first == settled_seed && settled_count < count; it = finished.erase(it)) {
+					settled_count += it->second ? 1 : 0;
+					++settled_seed;
+				}
+			}
+		}));
+	}
+	for(std::thread & worker : workers) {
+		worker.join();
+	}
+	unsigned attempts = settled_seed - first_seed;
+	std::vector<GeneratedLevel> levels;
+	for(std::map<unsigned, Generator::Level>::const_iterator it = accepted.begin(); it != accepted.end() && int(levels.size()) < count; ++it) {
+		GeneratedLevel generated = { it->first, it->second };
+		levels.push_back(generated);
+	}
+	double seconds = std::chrono::duration<double>(Clock::now() - start_time).count();
+
+	std::ofstream out(argv[1]);
+	writeLevelSet(out, Chthon::format("Generated {0}x{1}, {2} boxes", options.width, options.height, options.box_count), levels, options.width, options.height);
+	if(!out) {
+		std::cerr << "Cannot write levelset: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	double difficulty = 0;
+	for(const GeneratedLevel & generated : levels) {
+		difficulty += generated.level.difficulty;
+	}
+	std::cerr << Chthon::format("{0} levels from {1} attempts in {2} sec: {3} levels per minute at {4}+ pushes, average difficulty {5}.",
+			levels.size(), attempts, seconds, levels.size() * 60 / seconds, options.min_pushes, difficulty / levels.size()
+			) << std::endl;
+	return 0;
+}
@@ -0,0 +1,121 @@
+#include "../src/levelset.h"
+#include "../src/metrics.h"
+#include "../src/sokoban.h"
+#include "toolutils.h"
+#include <chthon2/format.h>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+
+namespace {
+
+const char * USAGE =
+	"Usage: miniban-metrics <levelset> [options]\n"
+	"  -o, --output <FILE>  sidecar file (default is <levelset>.metrics)\n"
+	"  -t, --time <SEC>     solver time limit per level (default is 10)\n"
+	"  -m, --memory <MB>    solver memory limit per level\n"
+	"  -j, --threads <N>    number of levels analysed at once (default is number of cores)\n"
+	;
+
+// Number of slowest levels reported at the end.
+const unsigned SLOWEST_COUNT = 5;
+
+std::string metricsLine(const LevelSet & levelSet, int level, const Solver::Limits & limits, double & seconds)
+{
+	std::ostringstream out;
+	out << "{\"level\": " << (level + 1) << ", \"name\": " << jsonString(levelSet.getLevelName(level));
+	Sokoban sokoban;
+	try {
+		sokoban = levelSet.getSokoban(level);
+	} catch(const Sokoban::InvalidPlayerCountException & e) {
+		out << ", \"status\": \"invalid\"}";
+		return out.str();
+	}
+	LevelMetrics metrics = LevelMetrics::analyze(sokoban, limits);
+	seconds = metrics.search.seconds;
+	out << ", \"boxes\": " << metrics.box_count
+		<< ", \"floor_area\": " << metrics.floor_area
+		<< ", \"goal_rooms\": " << metrics.goal_rooms
+		<< ", \"largest_goal_room\": " << metrics.largest_goal_room
+		<< ", \"room_goals\": " << metrics.room_goals
+		<< ", \"packed_goals\": " << metrics.packed_goals
+		<< ", \"dead_ratio\": " << metrics.dead_ratio
+		<< ", \"status\": \"" << Solver::getStatusName(metrics.search.status) << "\""
+		<< ", \"nodes\": " << metrics.search.nodes
+		<< ", \"seconds\": " << metrics.search.seconds;
+	if(metrics.search.status == Solver::SOLVED) {
+		out << ", \"pushes\": " << metrics.search.pushes
+			<< ", \"moves\": " << metrics.search.moves;
+	}
+	out << "}";
+	return out.str();
+}
+
+}
+
+// Analyses every level of levelset and writes one JSON line of metrics per level
+// into sidecar file, in level order. Slowest levels are reported to stderr.
+int main(int argc, char ** argv)
+{
+	if(argc < 2) {
+		std::cerr << USAGE;
+		return 1;
+	}
+	std::string output = std::string(argv[1]) + ".metrics";
+	Solver::Limits limits;
+	limits.seconds = 10;
+	int thread_count = std::thread::hardware_concurrency();
+	for(int i = 2; i < argc; ++i) {
+		std::string option = argv[i];
+		if(i + 1 >= argc) {
+			std::cerr << USAGE;
+			return 1;
+		}
+		const char * value = argv[++i];
+		if(option == "-o" || option == "--output") {
+			output = value;
+		} else if(option == "-t" || option == "--time") {
+			limits.seconds = atof(value);
+		} else if(option == "-m" || option == "--memory") {
+			limits.memory_bytes = size_t(atof(value) * 1024 * 1024);
+		} else if(option == "-j" || option == "--threads") {
+			thread_count = atoi(value);
+		} else {
+			std::cerr << USAGE;
+			return 1;
+		}
+	}
+	thread_count = std::max(1, thread_count);
+
+	LevelSet levelSet;
+	if(!levelSet.loadFromFile(argv[1], 0)) {
+		std::cerr << "Cannot load levelset: " << argv[1] << std::endl;
+		return 1;
+	}
+	std::ofstream out(output.c_str());
+	if(!out) {
+		std::cerr << "Cannot write metrics: " << output << std::endl;
+		return 1;
+	}
+
+	std::vector<double> seconds(levelSet.getLevelCount(), 0);
+	processLevelsInOrder(0, levelSet.getLevelCount(), thread_count,
+			[&](int level) { return metricsLine(levelSet, level, limits, seconds[level]); },
+			[&out](const std::string & line) { out << line << std::endl; });
+
+	std::vector<int> slowest(seconds.size());
+	for(unsigned i = 0; i < slowest.size(); ++i) {
+		slowest[i] = i;
+	}
+	unsigned slowest_count = std::min<unsigned>(SLOWEST_COUNT, slowest.size());
+	std::partial_sort(slowest.begin(), slowest.begin() + slowest_count, slowest.end(), [&seconds](int a, int b) {
+			return seconds[a] > seconds[b];
+			});
+	for(unsigned i = 0; i < slowest_count; ++i) {
+		std::cerr << Chthon::format("Level {0} ({1}): {2} sec", slowest[i] + 1, levelSet.getLevelName(slowest[i]), seconds[slowest[i]]) << std::endl;
+	}
+	return out ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+#include "../src/levelset.h"
+#include "../src/optimizer.h"
+#include "../src/solution.h"
+#include "../src/sokoban.h"
+#include <chthon2/format.h>
+#include <iostream>
+#include <iterator>
+#include <cctype>
+#include <cstdlib>
+
+namespace {
+
+const char * USAGE =
+	"Usage: miniban-optimize <levelset> <level> [options]\n"
+	"  -s, --solution <LURD>  solution to optimize (default is read from stdin)\n"
+	"  -w, --window <N>       number of pushes re-solved at once (default is 8)\n"
+	"  -t, --time <SEC>       time limit for the whole optimization (default is 10)\n"
+	;
+
+}
+
+// Optimizes solution of one level and prints moves and pushes before and after
+// with the new solution as a JSON line. New solution is verified by replaying it on the level.
+int main(int argc, char ** argv)
+{
+	if(argc < 3) {
+		std::cerr << USAGE;
+		return 1;
+	}
+	int level = atoi(argv[2]);
+	std::string solution;
+	bool has_solution = false;
+	Optimizer::Options options;
+	for(int i = 3; i < argc; ++i) {
+		std::string option = argv[i];
+		if(i + 1 >= argc) {
+			std::cerr << USAGE;
+			return 1;
+		}
+		const char * value = argv[++i];
+		if(option == "-s" || option == "--solution") {
+			solution = value;
+			has_solution = true;
+		} else if(option == "-w" || option == "--window") {
+			options.window = atoi(value);
+		} else if(option == "-t" || option == "--time") {
+			options.seconds = atof(value);
+		} else {
+			std::cerr << USAGE;
+			return 1;
+		}
+	}
+	if(!has_solution) {
+		std::string text((std::istreambuf_iterator<char>(std::cin)), std::istreambuf_iterator<char>());
+		for(char ch : text) {
+			if(!isspace((unsigned char)ch)) {
+				solution += ch;
+			}
+		}
+	}
+
+	LevelSet levelSet;
+	if(!levelSet.loadFromFile(argv[1], 0)) {
+		std::cerr << "Cannot load levelset: " << argv[1] << std::endl;
+		return 1;
+	}
+	if(level < 1 || level > levelSet.getLevelCount()) {
+		std::cerr << Chthon::format("There are only {0} levels.", levelSet.getLevelCount()) << std::endl;
+		return 1;
+	}
+	Sokoban sokoban = levelSet.getSokoban(level - 1);
+	Optimizer::Result result = Optimizer(sokoban).optimize(solution, options);
+	if(!result.valid) {
+		std::cerr << "Solution does not solve the level." << std::endl;
+		return 1;
+	}
+	bool verified = Solution(result.solution).verify(sokoban);
+	std::cout << "{\"level\": " << level
+		<< ", \"moves_before\": " << result.moves_before
+		<< ", \"pushes_before\": " << result.pushes_before
+		<< ", \"moves\": " << result.moves
+		<< ", \"pushes\": " << result.pushes
+		<< ", \"windows\": " << result.windows
+		<< ", \"improvements\": " << result.improvements
+		<< ", \"unsolved_windows\": " << result.unsolved_windows
+		<< ", \"seconds\": " << result.seconds
+		<< ", \"verified\": " << (verified ? "true" : "false")
+		<< ", \"solution\": \"" << result.solution << "\"}" << std::endl;
+	return verified ? 0 : 1;
+}
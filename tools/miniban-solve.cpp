@@ -0,0 +1,127 @@
+#include "../src/levelset.h"
+#include "../src/solver.h"
+#include "../src/solution.h"
+#include "toolutils.h"
+#include <chthon2/format.h>
+#include <thread>
+#include <sstream>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+const char * USAGE =
+	"Usage: miniban-solve <levelset> [options]\n"
+	"  -l, --level <N>    solve only level N (starting from 1)\n"
+	"  -t, --time <SEC>   time limit per level\n"
+	"  -m, --memory <MB>  memory limit per level\n"
+	"  -j, --threads <N>  number of levels solved at once (default is number of cores)\n"
+	"  -x, --disable <L>  comma-separated search enhancements to switch off: rooms, tunnels, corrals\n"
+	;
+
+bool disableEnhancements(const std::string & list, Solver::Options & options)
+{
+	std::istringstream in(list);
+	std::string name;
+	while(std::getline(in, name, ',')) {
+		if(name == "rooms") {
+			options.goal_room_macros = false;
+		} else if(name == "tunnels") {
+			options.tunnel_macros = false;
+		} else if(name == "corrals") {
+			options.pi_corrals = false;
+		} else {
+			return false;
+		}
+	}
+	return true;
+}
+
+std::string solveLevel(const LevelSet & levelSet, int level, const Solver::Limits & limits, const Solver::Options & options)
+{
+	std::ostringstream out;
+	out << "{\"level\": " << (level + 1) << ", \"name\": " << jsonString(levelSet.getLevelName(level));
+	Sokoban sokoban;
+	try {
+		sokoban = levelSet.getSokoban(level);
+	} catch(const Sokoban::InvalidPlayerCountException & e) {
+		out << ", \"status\": \"invalid\"}";
+		return out.str();
+	}
+	Solver::Result result = Solver(sokoban, options).solve(limits);
+	out << ", \"status\": \"" << Solver::getStatusName(result.status) << "\""
+		<< ", \"nodes\": " << result.nodes
+		<< ", \"seconds\": " << result.seconds
+		<< ", \"peak_memory_bytes\": " << result.peak_memory_bytes;
+	if(result.status == Solver::SOLVED) {
+		out << ", \"moves\": " << result.moves
+			<< ", \"pushes\": " << result.pushes
+			<< ", \"verified\": " << (Solution(result.solution).verify(sokoban) ? "true" : "false")
+			<< ", \"solution\": \"" << result.solution << "\"";
+	}
+	out << "}";
+	return out.str();
+}
+
+}
+
+// Solves levels of levelset and prints solution and search statistics
+// for every level as a JSON line, in level order. Does not use SDL or display.
+int main(int argc, char ** argv)
+{
+	if(argc < 2) {
+		std::cerr << USAGE;
+		return 1;
+	}
+	int selected_level = 0;
+	Solver::Limits limits;
+	Solver::Options options;
+	int thread_count = std::thread::hardware_concurrency();
+	for(int i = 2; i < argc; ++i) {
+		std::string option = argv[i];
+		if(i + 1 >= argc) {
+			std::cerr << USAGE;
+			return 1;
+		}
+		const char * value = argv[++i];
+		if(option == "-l" || option == "--level") {
+			selected_level = atoi(value);
+		} else if(option == "-t" || option == "--time") {
+			limits.seconds = atof(value);
+		} else if(option == "-m" || option == "--memory") {
+			limits.memory_bytes = size_t(atof(value) * 1024 * 1024);
+		} else if(option == "-j" || option == "--threads") {
+			thread_count = atoi(value);
+		} else if(option == "-x" || option == "--disable") {
+			if(!disableEnhancements(value, options)) {
+				std::cerr << USAGE;
+				return 1;
+			}
+		} else {
+			std::cerr << USAGE;
+			return 1;
+		}
+	}
+	thread_count = std::max(1, thread_count);
+
+	LevelSet levelSet;
+	if(!levelSet.loadFromFile(argv[1], 0)) {
+		std::cerr << "Cannot load levelset: " << argv[1] << std::endl;
+		return 1;
+	}
+	int first_level = 0, last_level = levelSet.getLevelCount();
+	if(selected_level > 0) {
+		if(selected_level > levelSet.getLevelCount()) {
+			std::cerr << Chthon::format("There are only {0} levels.", levelSet.getLevelCount()) << std::endl;
+			return 1;
+		}
+		first_level = selected_level - 1;
+		last_level = selected_level;
+	}
+
+	processLevelsInOrder(first_level, last_level, thread_count,
+			[&](int level) { return solveLevel(levelSet, level, limits, options); },
+			[](const std::string & line) { std::cout << line << std::endl; });
+	return 0;
+}
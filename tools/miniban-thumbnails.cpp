@@ -0,0 +1,55 @@
+#include "../src/levelset.h"
+#include "../src/thumbnail.h"
+#include <chthon2/format.h>
+#include <atomic>
+#include <thread>
+#include <iostream>
+#include <cstdlib>
+
+// Renders thumbnail of every level in levelset into <output_dir>/<level number>.ppm.
+// Does not use SDL, levels are distributed between worker threads.
+int main(int argc, char ** argv)
+{
+	if(argc < 3) {
+		std::cerr << "Usage: miniban-thumbnails <levelset> <output_dir> [tile_size] [threads]" << std::endl;
+		return 1;
+	}
+	std::string output_dir = argv[2];
+	int tile_size = (argc > 3) ? atoi(argv[3]) : 4;
+	int thread_count = (argc > 4) ? atoi(argv[4]) : std::thread::hardware_concurrency();
+	thread_count = std::max(1, thread_count);
+	tile_size = std::max(1, tile_size);
+
+	LevelSet levelSet;
+	if(!levelSet.loadFromFile(argv[1], 0)) {
+		std::cerr << "Cannot load levelset: " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::atomic<int> next_level(0);
+	std::atomic<int> failed(0);
+	std::vector<std::thread> workers;
+	for(int i = 0; i < thread_count; ++i) {
+		workers.push_back(std::thread([&]() {
+			for(int level = next_level++; level < levelSet.getLevelCount(); level = next_level++) {
+				std::string file_name = Chthon::format("{0}/{1}.ppm", output_dir, level + 1);
+				try {
+					Thumbnail thumbnail(levelSet.getSokoban(level), tile_size);
+					if(!thumbnail.savePPM(file_name)) {
+						++failed;
+					}
+				} catch(const Sokoban::InvalidPlayerCountException & e) {
+					++failed;
+				}
+			}
+		}));
+	}
+	for(std::thread & worker : workers) {
+		worker.join();
+	}
+	if(failed > 0) {
+		std::cerr << Chthon::format("Failed to render {0} of {1} levels.", int(failed), levelSet.getLevelCount()) << std::endl;
+		return 1;
+	}
+	return 0;
+}
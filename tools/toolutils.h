@@ -0,0 +1,55 @@
+#pragma once
+#include <chthon2/format.h>
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Helpers shared by command line tools. Every tools/*.cpp is a separate binary, so they are kept in header.
+
+inline std::string jsonString(const std::string & value)
+{
+	std::string result = "\"";
+	for(char ch : value) {
+		if(ch == '"' || ch == '\\') {
+			result += '\\';
+			result += ch;
+		} else if((unsigned char)(ch) < 0x20) {
+			result += Chthon::format("\\u00{0}{1}", "0123456789abcdef"[(ch >> 4) & 0xf], "0123456789abcdef"[ch & 0xf]);
+		} else {
+			result += ch;
+		}
+	}
+	return result + "\"";
+}
+
+// Calls process(level) for levels from first to last (exclusive) by several threads
+// and passes returned lines to write(line) in level order, as soon as all previous levels are done.
+template<class Process, class Write>
+void processLevelsInOrder(int first_level, int last_level, int thread_count, Process process, Write write)
+{
+	// Finished levels wait here until all previous ones are written.
+	std::vector<std::string> lines(last_level - first_level);
+	std::vector<bool> finished(lines.size(), false);
+	unsigned next_to_write = 0;
+	std::mutex output_mutex;
+	std::atomic<int> next_level(first_level);
+	std::vector<std::thread> workers;
+	for(int i = 0; i < thread_count; ++i) {
+		workers.push_back(std::thread([&]() {
+			for(int level = next_level++; level < last_level; level = next_level++) {
+				std::string line = process(level);
+				std::lock_guard<std::mutex> lock(output_mutex);
+				lines[level - first_level] = line;
+				finished[level - first_level] = true;
+				for(; next_to_write < lines.size() && finished[next_to_write]; ++next_to_write) {
+					write(lines[next_to_write]);
+				}
+			}
+		}));
+	}
+	for(std::thread & worker : workers) {
+		worker.join();
+	}
+}